@@ -2,6 +2,7 @@
 
 #include <inttypes.h>
 #include <malloc.h>
+#include <pthread.h>
 #include <stdlib.h>
 #include <sys/mman.h>
 #include <sys/stat.h>
@@ -42,6 +43,84 @@ DEFINE_TRIVIAL_CLEANUP_FUNC_FULL(LZ4F_decompressionContext_t, LZ4F_freeDecompres
 DEFINE_TRIVIAL_CLEANUP_FUNC_FULL(ZSTD_CCtx*, ZSTD_freeCCtx, NULL);
 DEFINE_TRIVIAL_CLEANUP_FUNC_FULL(ZSTD_DCtx*, ZSTD_freeDCtx, NULL);
 
+/* Setting up a zstd context is expensive compared to (de)compressing the short blobs we usually deal with
+ * (think journal fields), hence keep one context of each kind around per thread, instead of creating and
+ * destroying them on each call. They are released by the key destructor when the thread exits, since
+ * compress.c is part of libsystemd and we don't control the lifetime of our callers' threads. The key
+ * itself is deliberately never deleted: pthread_key_delete() does not run the destructors for the values
+ * of other threads, and a library can't know when the last thread is done with it. That costs one of the
+ * PTHREAD_KEYS_MAX slots per process. */
+typedef struct ZstdContexts {
+        ZSTD_CCtx *cctx;
+        ZSTD_DCtx *dctx;
+} ZstdContexts;
+
+static pthread_key_t zstd_contexts_key;
+
+static void zstd_contexts_free(void *p) {
+        ZstdContexts *c = p;
+
+        if (!c)
+                return;
+
+        ZSTD_freeCCtx(c->cctx);
+        ZSTD_freeDCtx(c->dctx);
+        free(c);
+}
+
+static void zstd_contexts_key_initialize(void) {
+        assert_se(pthread_key_create(&zstd_contexts_key, zstd_contexts_free) == 0);
+}
+
+static ZstdContexts* zstd_contexts_get(void) {
+        static pthread_once_t once = PTHREAD_ONCE_INIT;
+        ZstdContexts *c;
+
+        assert_se(pthread_once(&once, zstd_contexts_key_initialize) == 0);
+
+        c = pthread_getspecific(zstd_contexts_key);
+        if (c)
+                return c;
+
+        c = new0(ZstdContexts, 1);
+        if (!c)
+                return NULL;
+
+        if (pthread_setspecific(zstd_contexts_key, c) != 0)
+                return mfree(c);
+
+        return c;
+}
+
+static ZSTD_CCtx* zstd_cctx_get(void) {
+        ZstdContexts *c;
+
+        c = zstd_contexts_get();
+        if (!c)
+                return NULL;
+
+        if (!c->cctx)
+                c->cctx = ZSTD_createCCtx();
+
+        return c->cctx;
+}
+
+static ZSTD_DCtx* zstd_dctx_get(void) {
+        ZstdContexts *c;
+
+        c = zstd_contexts_get();
+        if (!c)
+                return NULL;
+
+        if (!c->dctx)
+                c->dctx = ZSTD_createDCtx();
+        else
+                /* A previous user might have bailed out in the middle of a frame */
+                (void) ZSTD_DCtx_reset(c->dctx, ZSTD_reset_session_only);
+
+        return c->dctx;
+}
+
 static int zstd_ret_to_errno(size_t ret) {
         switch (ZSTD_getErrorCode(ret)) {
         case ZSTD_error_dstSize_tooSmall:
@@ -147,6 +226,7 @@ int compress_blob_zstd(
                 const void *src, uint64_t src_size,
                 void *dst, size_t dst_alloc_size, size_t *dst_size) {
 #if HAVE_ZSTD
+        ZSTD_CCtx *cctx;
         size_t k;
 
         assert(src);
@@ -155,7 +235,11 @@ int compress_blob_zstd(
         assert(dst_alloc_size > 0);
         assert(dst_size);
 
-        k = ZSTD_compress(dst, dst_alloc_size, src, src_size, 0);
+        cctx = zstd_cctx_get();
+        if (!cctx)
+                return -ENOMEM;
+
+        k = ZSTD_compressCCtx(cctx, dst, dst_alloc_size, src, src_size, 0);
         if (ZSTD_isError(k))
                 return zstd_ret_to_errno(k);
 
@@ -292,7 +376,7 @@ int decompress_blob_zstd(
         if (!(greedy_realloc(dst, MAX(ZSTD_DStreamOutSize(), size), 1)))
                 return -ENOMEM;
 
-        _cleanup_(ZSTD_freeDCtxp) ZSTD_DCtx *dctx = ZSTD_createDCtx();
+        ZSTD_DCtx *dctx = zstd_dctx_get();
         if (!dctx)
                 return -ENOMEM;
 
@@ -495,7 +579,7 @@ int decompress_startswith_zstd(
         if (size < prefix_len + 1)
                 return 0; /* Decompressed text too short to match the prefix and extra */
 
-        _cleanup_(ZSTD_freeDCtxp) ZSTD_DCtx *dctx = ZSTD_createDCtx();
+        ZSTD_DCtx *dctx = zstd_dctx_get();
         if (!dctx)
                 return -ENOMEM;
 
@@ -113,17 +113,96 @@ bool unit_has_host_root_cgroup(const Unit *u) {
         return unit_has_name(u, SPECIAL_ROOT_SLICE);
 }
 
-static int set_attribute_and_warn(Unit *u, const char *controller, const char *attribute, const char *value) {
+static void unit_forget_cgroup_attribute(Unit *u, const char *attribute) {
+        char *k;
+
+        assert(u);
+        assert(attribute);
+
+        free(hashmap_remove2(u->cgroup_attribute_cache, attribute, (void**) &k));
+        free(k);
+}
+
+int unit_remember_cgroup_attribute(Unit *u, const char *attribute, const char *value) {
+        _cleanup_free_ char *a = NULL, *v = NULL;
         int r;
 
-        r = cg_set_attribute(controller, u->cgroup_path, attribute, value);
+        assert(u);
+        assert(attribute);
+        assert(value);
+
+        a = strdup(attribute);
+        v = strdup(value);
+        if (!a || !v)
+                return -ENOMEM;
+
+        unit_forget_cgroup_attribute(u, attribute);
+
+        r = hashmap_ensure_put(&u->cgroup_attribute_cache, &string_hash_ops_free_free, a, v);
         if (r < 0)
+                return r;
+
+        TAKE_PTR(a);
+        TAKE_PTR(v);
+        return 0;
+}
+
+static bool unit_cgroup_attribute_is_current(Unit *u, const char *controller, const char *attribute, const char *value) {
+        _cleanup_free_ char *current = NULL;
+
+        assert(u);
+        assert(attribute);
+        assert(value);
+
+        if (!streq_ptr(hashmap_get(u->cgroup_attribute_cache, attribute), value))
+                return false;
+
+        /* The cache only tells us what we wrote last. The attribute might have been changed since, either
+         * directly in cgroupfs or as a side effect of writing another attribute, hence check that the value
+         * is still in effect. Reading an attribute is much cheaper than writing it, which might e.g. trigger
+         * memory reclaim or reweighting of the scheduler entities. Values the kernel normalizes (e.g. byte
+         * counts rounded to the page size) never match, and are hence always written, as before. */
+        if (cg_get_attribute(controller, u->cgroup_path, attribute, &current) < 0)
+                return false;
+
+        return streq_skip_trailing_chars(current, value, NEWLINE);
+}
+
+static int set_attribute_and_warn_full(Unit *u, const char *controller, const char *attribute, const char *value, bool cache) {
+        int r;
+
+        /* If 'cache' is true, the attribute is assumed to hold a single value that is entirely replaced by
+         * each write, hence if we wrote the very same value to it before and it is still in effect, there's
+         * no need to write it again. Attributes that carry one line per device (such as io.max) must not be
+         * cached this way, since a write only changes the line of the specified device. */
+
+        if (cache && unit_cgroup_attribute_is_current(u, controller, attribute, value))
+                return 0;
+
+        r = cg_set_attribute(controller, u->cgroup_path, attribute, value);
+        if (r < 0) {
                 log_unit_full_errno(u, LOG_LEVEL_CGROUP_WRITE(r), r, "Failed to set '%s' attribute on '%s' to '%.*s': %m",
                                     strna(attribute), empty_to_root(u->cgroup_path), (int) strcspn(value, NEWLINE), value);
 
+                /* We don't know what the attribute is set to now, hence make sure to write it next time */
+                if (cache)
+                        unit_forget_cgroup_attribute(u, attribute);
+
+                return r;
+        }
+
+        if (cache && unit_remember_cgroup_attribute(u, attribute, value) < 0) {
+                log_oom_debug();
+                unit_forget_cgroup_attribute(u, attribute);
+        }
+
         return r;
 }
 
+static int set_attribute_and_warn(Unit *u, const char *controller, const char *attribute, const char *value) {
+        return set_attribute_and_warn_full(u, controller, attribute, value, /* cache= */ true);
+}
+
 static void cgroup_compat_warn(void) {
         static bool cgroup_compat_warned = false;
 
@@ -1209,6 +1288,11 @@ static void cgroup_apply_unified_cpu_idle(Unit *u, uint64_t weight) {
         is_idle = weight == CGROUP_WEIGHT_IDLE;
         idle_val = one_zero(is_idle);
         r = cg_set_attribute("cpu", u->cgroup_path, "cpu.idle", idle_val);
+
+        /* When a group is switched from idle back to non-idle, the kernel resets its weight to the default,
+         * hence make sure cpu.weight is written again afterwards. */
+        unit_forget_cgroup_attribute(u, "cpu.weight");
+
         if (r < 0 && (r != -ENOENT || is_idle))
                 log_unit_full_errno(u, LOG_LEVEL_CGROUP_WRITE(r), r, "Failed to set '%s' attribute on '%s' to '%s': %m",
                                     "cpu.idle", empty_to_root(u->cgroup_path), idle_val);
@@ -1395,7 +1479,7 @@ static void cgroup_apply_blkio_device_weight(Unit *u, const char *dev_path, uint
                 return;
 
         xsprintf(buf, DEVNUM_FORMAT_STR " %" PRIu64 "\n", DEVNUM_FORMAT_VAL(dev), blkio_weight);
-        (void) set_attribute_and_warn(u, "blkio", "blkio.weight_device", buf);
+        (void) set_attribute_and_warn_full(u, "blkio", "blkio.weight_device", buf, /* cache= */ false);
 }
 
 static void cgroup_apply_io_device_latency(Unit *u, const char *dev_path, usec_t target) {
@@ -1412,7 +1496,7 @@ static void cgroup_apply_io_device_latency(Unit *u, const char *dev_path, usec_t
         else
                 xsprintf(buf, DEVNUM_FORMAT_STR " target=max\n", DEVNUM_FORMAT_VAL(dev));
 
-        (void) set_attribute_and_warn(u, "io", "io.latency", buf);
+        (void) set_attribute_and_warn_full(u, "io", "io.latency", buf, /* cache= */ false);
 }
 
 static void cgroup_apply_io_device_limit(Unit *u, const char *dev_path, uint64_t *limits) {
@@ -1432,7 +1516,7 @@ static void cgroup_apply_io_device_limit(Unit *u, const char *dev_path, uint64_t
         xsprintf(buf, DEVNUM_FORMAT_STR " rbps=%s wbps=%s riops=%s wiops=%s\n", DEVNUM_FORMAT_VAL(dev),
                  limit_bufs[CGROUP_IO_RBPS_MAX], limit_bufs[CGROUP_IO_WBPS_MAX],
                  limit_bufs[CGROUP_IO_RIOPS_MAX], limit_bufs[CGROUP_IO_WIOPS_MAX]);
-        (void) set_attribute_and_warn(u, "io", "io.max", buf);
+        (void) set_attribute_and_warn_full(u, "io", "io.max", buf, /* cache= */ false);
 }
 
 static void cgroup_apply_blkio_device_limit(Unit *u, const char *dev_path, uint64_t rbps, uint64_t wbps) {
@@ -1443,10 +1527,10 @@ static void cgroup_apply_blkio_device_limit(Unit *u, const char *dev_path, uint6
                 return;
 
         sprintf(buf, DEVNUM_FORMAT_STR " %" PRIu64 "\n", DEVNUM_FORMAT_VAL(dev), rbps);
-        (void) set_attribute_and_warn(u, "blkio", "blkio.throttle.read_bps_device", buf);
+        (void) set_attribute_and_warn_full(u, "blkio", "blkio.throttle.read_bps_device", buf, /* cache= */ false);
 
         sprintf(buf, DEVNUM_FORMAT_STR " %" PRIu64 "\n", DEVNUM_FORMAT_VAL(dev), wbps);
-        (void) set_attribute_and_warn(u, "blkio", "blkio.throttle.write_bps_device", buf);
+        (void) set_attribute_and_warn_full(u, "blkio", "blkio.throttle.write_bps_device", buf, /* cache= */ false);
 }
 
 static bool unit_has_unified_memory_config(Unit *u) {
@@ -2495,6 +2579,12 @@ static int unit_update_cgroup(
                 return log_unit_error_errno(u, r, "Failed to create cgroup %s: %m", empty_to_root(u->cgroup_path));
         created = r;
 
+        /* A freshly created cgroup carries the kernel's defaults, and if the set of controllers changed,
+         * attribute files might have been removed and recreated in the meantime. Either way, what we wrote
+         * before is not what's in effect now. */
+        if (created || target_mask != u->cgroup_realized_mask)
+                u->cgroup_attribute_cache = hashmap_free(u->cgroup_attribute_cache);
+
         if (cg_unified_controller(SYSTEMD_CGROUP_CONTROLLER) > 0) {
                 uint64_t cgroup_id = 0;
 
@@ -3081,6 +3171,8 @@ void unit_release_cgroup(Unit *u) {
                 u->cgroup_path = mfree(u->cgroup_path);
         }
 
+        u->cgroup_attribute_cache = hashmap_free(u->cgroup_attribute_cache);
+
         if (u->cgroup_control_inotify_wd >= 0) {
                 if (inotify_rm_watch(u->manager->cgroup_inotify_fd, u->cgroup_control_inotify_wd) < 0)
                         log_unit_debug_errno(u, errno, "Failed to remove cgroup control inotify watch %i for %s, ignoring: %m", u->cgroup_control_inotify_wd, u->id);
@@ -4367,6 +4459,106 @@ done:
         return 0;
 }
 
+void unit_accounting_free_many(UnitAccounting *accounting, size_t n) {
+        assert(accounting || n == 0);
+
+        FOREACH_ARRAY(a, accounting, n)
+                free(a->id);
+
+        free(accounting);
+}
+
+static int unit_get_accounting(Unit *u, UnitAccounting *ret) {
+        _cleanup_free_ char *id = NULL;
+        UnitAccounting a = {
+                .cpu_usage = NSEC_INFINITY,
+                .memory_current = UINT64_MAX,
+                .memory_peak = UINT64_MAX,
+                .tasks_current = UINT64_MAX,
+                .io_read_bytes = UINT64_MAX,
+                .io_write_bytes = UINT64_MAX,
+                .ip_ingress_bytes = UINT64_MAX,
+                .ip_egress_bytes = UINT64_MAX,
+        };
+
+        assert(u);
+        assert(ret);
+
+        id = strdup(u->id);
+        if (!id)
+                return -ENOMEM;
+
+        /* All of these return -ENODATA if the respective accounting is turned off, and leave the value
+         * untouched on failure, hence there's no need to check for errors here. */
+        (void) unit_get_cpu_usage(u, &a.cpu_usage);
+        (void) unit_get_memory_current(u, &a.memory_current);
+        (void) unit_get_memory_accounting(u, CGROUP_MEMORY_PEAK, &a.memory_peak);
+        (void) unit_get_tasks_current(u, &a.tasks_current);
+        (void) unit_get_ip_accounting(u, CGROUP_IP_INGRESS_BYTES, &a.ip_ingress_bytes);
+        (void) unit_get_ip_accounting(u, CGROUP_IP_EGRESS_BYTES, &a.ip_egress_bytes);
+
+        /* Both IO counters are parsed from io.stat, read it only once */
+        if (unit_get_io_accounting(u, CGROUP_IO_READ_BYTES, /* allow_cache= */ false, &a.io_read_bytes) >= 0)
+                (void) unit_get_io_accounting(u, CGROUP_IO_WRITE_BYTES, /* allow_cache= */ true, &a.io_write_bytes);
+
+        a.id = TAKE_PTR(id);
+        *ret = a;
+        return 0;
+}
+
+int manager_get_accounting_snapshot(Manager *m, usec_t max_age, const UnitAccounting **ret, size_t *ret_n) {
+        UnitAccounting *accounting = NULL;
+        size_t n = 0;
+        usec_t ts;
+        const char *k;
+        Unit *u;
+        int r;
+
+        CLEANUP_ARRAY(accounting, n, unit_accounting_free_many);
+
+        assert(m);
+        assert(ret);
+        assert(ret_n);
+
+        /* Returns the resource accounting data of all units that have a cgroup. If the data collected
+         * previously is not older than 'max_age', it is returned again, instead of reading the cgroup
+         * attributes of every unit anew. This way, clients that poll this regularly can put an upper bound
+         * on the work we do on their behalf. */
+
+        ts = now(CLOCK_MONOTONIC);
+
+        if (m->accounting_snapshot_timestamp > 0 &&
+            usec_add(m->accounting_snapshot_timestamp, max_age) > ts)
+                goto done;
+
+        HASHMAP_FOREACH_KEY(u, k, m->units) {
+                if (k != u->id)
+                        continue;
+
+                if (!UNIT_HAS_CGROUP_CONTEXT(u) || !u->cgroup_path)
+                        continue;
+
+                if (!GREEDY_REALLOC(accounting, n + 1))
+                        return -ENOMEM;
+
+                r = unit_get_accounting(u, accounting + n);
+                if (r < 0)
+                        return r;
+
+                n++;
+        }
+
+        unit_accounting_free_many(m->accounting_snapshot, m->n_accounting_snapshot);
+        m->accounting_snapshot = TAKE_PTR(accounting);
+        m->n_accounting_snapshot = n;
+        m->accounting_snapshot_timestamp = ts;
+
+done:
+        *ret = m->accounting_snapshot;
+        *ret_n = m->n_accounting_snapshot;
+        return 0;
+}
+
 int unit_reset_cpu_accounting(Unit *u) {
         int r;
 
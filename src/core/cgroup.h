@@ -276,6 +276,20 @@ typedef enum CGroupMemoryAccountingMetric {
         _CGROUP_MEMORY_ACCOUNTING_METRIC_INVALID = -EINVAL,
 } CGroupMemoryAccountingMetric;
 
+/* Resource accounting data of a single unit, as collected by manager_get_accounting_snapshot(). Fields
+ * are UINT64_MAX (NSEC_INFINITY for cpu_usage) if the data is not available. */
+typedef struct UnitAccounting {
+        char *id;
+        nsec_t cpu_usage;
+        uint64_t memory_current;
+        uint64_t memory_peak;
+        uint64_t tasks_current;
+        uint64_t io_read_bytes;
+        uint64_t io_write_bytes;
+        uint64_t ip_ingress_bytes;
+        uint64_t ip_egress_bytes;
+} UnitAccounting;
+
 typedef struct Unit Unit;
 typedef struct Manager Manager;
 typedef enum ManagerState ManagerState;
@@ -337,6 +351,7 @@ int unit_watch_cgroup_memory(Unit *u);
 void unit_add_to_cgroup_realize_queue(Unit *u);
 
 void unit_release_cgroup(Unit *u);
+int unit_remember_cgroup_attribute(Unit *u, const char *attribute, const char *value);
 /* Releases the cgroup only if it is recursively empty.
  * Returns true if the cgroup was released, false otherwise. */
 bool unit_maybe_release_cgroup(Unit *u);
@@ -375,6 +390,9 @@ int unit_get_cpu_usage(Unit *u, nsec_t *ret);
 int unit_get_io_accounting(Unit *u, CGroupIOAccountingMetric metric, bool allow_cache, uint64_t *ret);
 int unit_get_ip_accounting(Unit *u, CGroupIPAccountingMetric metric, uint64_t *ret);
 
+void unit_accounting_free_many(UnitAccounting *accounting, size_t n);
+int manager_get_accounting_snapshot(Manager *m, usec_t max_age, const UnitAccounting **ret, size_t *ret_n);
+
 int unit_reset_cpu_accounting(Unit *u);
 void unit_reset_memory_accounting_last(Unit *u);
 int unit_reset_ip_accounting(Unit *u);
@@ -231,6 +231,34 @@ static int property_get_environment(
         return sd_bus_message_append_strv(reply, l);
 }
 
+static int property_get_generator_timings(
+                sd_bus *bus,
+                const char *path,
+                const char *interface,
+                const char *property,
+                sd_bus_message *reply,
+                void *userdata,
+                sd_bus_error *error) {
+
+        Manager *m = ASSERT_PTR(userdata);
+        int r;
+
+        assert(bus);
+        assert(reply);
+
+        r = sd_bus_message_open_container(reply, 'a', "(st)");
+        if (r < 0)
+                return r;
+
+        FOREACH_ARRAY(t, m->generator_timings, m->n_generator_timings) {
+                r = sd_bus_message_append(reply, "(st)", t->path, t->duration);
+                if (r < 0)
+                        return r;
+        }
+
+        return sd_bus_message_close_container(reply);
+}
+
 static int property_get_show_status(
                 sd_bus *bus,
                 const char *path,
@@ -1294,6 +1322,98 @@ static int method_list_units_by_patterns(sd_bus_message *message, void *userdata
         return list_units_filtered(message, userdata, error, states, patterns);
 }
 
+/* Unprivileged callers may not make us reread the accounting data of all units more often than this */
+#define LIST_UNITS_ACCOUNTING_UNPRIVILEGED_MIN_AGE_USEC (5 * USEC_PER_SEC)
+
+static int method_list_units_accounting(sd_bus_message *message, void *userdata, sd_bus_error *error) {
+        _cleanup_(sd_bus_message_unrefp) sd_bus_message *reply = NULL;
+        Manager *m = ASSERT_PTR(userdata);
+        const UnitAccounting *accounting;
+        size_t n_accounting;
+        const char *name;
+        Unit *slice = NULL;
+        uint64_t max_age;
+        int r;
+
+        assert(message);
+
+        /* Anyone can call this method */
+
+        r = mac_selinux_access_check(message, "status", error);
+        if (r < 0)
+                return r;
+
+        r = sd_bus_message_read(message, "st", &name, &max_age);
+        if (r < 0)
+                return r;
+
+        /* Collecting the data means reading a bunch of cgroup attributes of every unit, hence don't let
+         * unprivileged clients force that on every call, but serve them the cached data instead. */
+        if (max_age < LIST_UNITS_ACCOUNTING_UNPRIVILEGED_MIN_AGE_USEC) {
+                r = sd_bus_query_sender_privilege(message, -1);
+                if (r < 0)
+                        return r;
+                if (r == 0)
+                        max_age = LIST_UNITS_ACCOUNTING_UNPRIVILEGED_MIN_AGE_USEC;
+        }
+
+        if (!isempty(name)) {
+                slice = manager_get_unit(m, name);
+                if (!slice)
+                        return sd_bus_error_setf(error, BUS_ERROR_NO_SUCH_UNIT, "Unit %s not loaded.", name);
+                if (slice->type != UNIT_SLICE)
+                        return sd_bus_error_setf(error, SD_BUS_ERROR_INVALID_ARGS, "Unit %s is not a slice.", name);
+        }
+
+        r = manager_get_accounting_snapshot(m, max_age, &accounting, &n_accounting);
+        if (r < 0)
+                return r;
+
+        r = sd_bus_message_new_method_return(message, &reply);
+        if (r < 0)
+                return r;
+
+        r = sd_bus_message_open_container(reply, 'a', "(sttttttt)");
+        if (r < 0)
+                return r;
+
+        FOREACH_ARRAY(a, accounting, n_accounting) {
+                Unit *u;
+
+                /* The snapshot might be a bit older than our unit table, hence look the unit up again, and
+                 * skip it if it's gone by now. */
+                u = manager_get_unit(m, a->id);
+                if (!u)
+                        continue;
+
+                if (slice) {
+                        while (u && u != slice)
+                                u = UNIT_GET_SLICE(u);
+                        if (!u)
+                                continue;
+                }
+
+                r = sd_bus_message_append(reply, "(sttttttt)",
+                                          a->id,
+                                          a->cpu_usage,
+                                          a->memory_current,
+                                          a->memory_peak,
+                                          a->tasks_current,
+                                          a->io_read_bytes,
+                                          a->io_write_bytes,
+                                          a->ip_ingress_bytes,
+                                          a->ip_egress_bytes);
+                if (r < 0)
+                        return r;
+        }
+
+        r = sd_bus_message_close_container(reply);
+        if (r < 0)
+                return r;
+
+        return sd_bus_send(NULL, reply, NULL);
+}
+
 static int method_list_jobs(sd_bus_message *message, void *userdata, sd_bus_error *error) {
         _cleanup_(sd_bus_message_unrefp) sd_bus_message *reply = NULL;
         Manager *m = ASSERT_PTR(userdata);
@@ -2977,6 +3097,7 @@ const sd_bus_vtable bus_manager_vtable[] = {
         BUS_PROPERTY_DUAL_TIMESTAMP("InitRDGeneratorsFinishTimestamp", offsetof(Manager, timestamps[MANAGER_TIMESTAMP_INITRD_GENERATORS_FINISH]), SD_BUS_VTABLE_PROPERTY_CONST),
         BUS_PROPERTY_DUAL_TIMESTAMP("InitRDUnitsLoadStartTimestamp", offsetof(Manager, timestamps[MANAGER_TIMESTAMP_INITRD_UNITS_LOAD_START]), SD_BUS_VTABLE_PROPERTY_CONST),
         BUS_PROPERTY_DUAL_TIMESTAMP("InitRDUnitsLoadFinishTimestamp", offsetof(Manager, timestamps[MANAGER_TIMESTAMP_INITRD_UNITS_LOAD_FINISH]), SD_BUS_VTABLE_PROPERTY_CONST),
+        SD_BUS_PROPERTY("GeneratorTimings", "a(st)", property_get_generator_timings, 0, 0),
         SD_BUS_WRITABLE_PROPERTY("LogLevel", "s", bus_property_get_log_level, property_set_log_level, 0, 0),
         SD_BUS_WRITABLE_PROPERTY("LogTarget", "s", bus_property_get_log_target, property_set_log_target, 0, 0),
         SD_BUS_PROPERTY("NNames", "u", property_get_hashmap_size, offsetof(Manager, units), 0),
@@ -3272,6 +3393,11 @@ const sd_bus_vtable bus_manager_vtable[] = {
                                 SD_BUS_RESULT("a(ssssssouso)", units),
                                 method_list_units_by_names,
                                 SD_BUS_VTABLE_UNPRIVILEGED),
+        SD_BUS_METHOD_WITH_ARGS("ListUnitsAccounting",
+                                SD_BUS_ARGS("s", slice, "t", max_age),
+                                SD_BUS_RESULT("a(sttttttt)", accounting),
+                                method_list_units_accounting,
+                                SD_BUS_VTABLE_UNPRIVILEGED),
         SD_BUS_METHOD_WITH_ARGS("ListJobs",
                                 SD_BUS_NO_ARGS,
                                 SD_BUS_RESULT("a(usssoo)", jobs),
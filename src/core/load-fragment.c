@@ -6191,6 +6191,7 @@ static int merge_by_names(Unit *u, Set *names, const char *id) {
 int unit_load_fragment(Unit *u) {
         const char *fragment;
         _cleanup_set_free_free_ Set *names = NULL;
+        uint64_t iteration = 0;
         int r;
 
         assert(u);
@@ -6203,14 +6204,24 @@ int unit_load_fragment(Unit *u) {
                 return 0;
         }
 
-        /* Possibly rebuild the fragment map to catch new units */
-        r = unit_file_build_name_map(&u->manager->lookup_paths,
-                                     &u->manager->unit_cache_timestamp_hash,
-                                     &u->manager->unit_id_map,
-                                     &u->manager->unit_name_map,
-                                     &u->manager->unit_path_cache);
-        if (r < 0)
-                return log_error_errno(r, "Failed to rebuild name map: %m");
+        /* Possibly rebuild the fragment map to catch new units. Checking whether the map is still up-to-date
+         * means a stat() per search path, which adds up quickly when loading many units in one go, i.e. at
+         * boot, when reloading or when processing a large transaction. Hence, do so at most once per event
+         * loop iteration (all loading done before the event loop is started counts as one iteration). The
+         * map is flushed when reloading, so it is always rebuilt after the generators ran. Units that show
+         * up on disk in the middle of an iteration are caught when their loading is retried. */
+        (void) sd_event_get_iteration(u->manager->event, &iteration);
+        if (!u->manager->unit_id_map || u->manager->unit_cache_iteration != iteration) {
+                r = unit_file_build_name_map(&u->manager->lookup_paths,
+                                             &u->manager->unit_cache_timestamp_hash,
+                                             &u->manager->unit_id_map,
+                                             &u->manager->unit_name_map,
+                                             &u->manager->unit_path_cache);
+                if (r < 0)
+                        return log_error_errno(r, "Failed to rebuild name map: %m");
+
+                u->manager->unit_cache_iteration = iteration;
+        }
 
         r = unit_file_find_fragment(u->manager->unit_id_map,
                                     u->manager->unit_name_map,
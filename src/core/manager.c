@@ -78,6 +78,7 @@
 #include "rlimit-util.h"
 #include "rm-rf.h"
 #include "selinux-util.h"
+#include "serialize.h"
 #include "signal-util.h"
 #include "socket-util.h"
 #include "special.h"
@@ -1685,6 +1686,8 @@ Manager* manager_free(Manager *m) {
 
         hashmap_free(m->cgroup_unit);
         manager_free_unit_name_maps(m);
+        exec_timing_free_many(m->generator_timings, m->n_generator_timings);
+        unit_accounting_free_many(m->accounting_snapshot, m->n_accounting_snapshot);
 
         free(m->switch_root);
         free(m->switch_root_init);
@@ -2259,7 +2262,13 @@ bool manager_unit_cache_should_retry_load(Unit *u) {
                 return true;
 
         /* The cache needs to be updated because there are modifications on disk. */
-        return !lookup_paths_timestamp_hash_same(&u->manager->lookup_paths, u->manager->unit_cache_timestamp_hash, NULL);
+        if (lookup_paths_timestamp_hash_same(&u->manager->lookup_paths, u->manager->unit_cache_timestamp_hash, NULL))
+                return false;
+
+        /* Make sure the cache is actually rebuilt when the unit is loaded again, even if the timestamps have
+         * already been checked in the current event loop iteration. */
+        u->manager->unit_cache_iteration = UINT64_MAX;
+        return true;
 }
 
 int manager_load_unit_prepare(
@@ -3969,7 +3978,7 @@ static int build_generator_environment(Manager *m, char ***ret) {
         return 0;
 }
 
-static int manager_execute_generators(Manager *m, char **paths, bool remount_ro) {
+static int manager_execute_generators(Manager *m, char **paths, bool remount_ro, int timings_fd) {
         _cleanup_strv_free_ char **ge = NULL;
         const char *argv[] = {
                 NULL, /* Leave this empty, execute_directory() will fill something in */
@@ -3997,18 +4006,37 @@ static int manager_execute_generators(Manager *m, char **paths, bool remount_ro)
         }
 
         BLOCK_WITH_UMASK(0022);
-        return execute_directories(
+        return execute_directories_full(
                         (const char* const*) paths,
                         DEFAULT_TIMEOUT_USEC,
                         /* callbacks= */ NULL, /* callback_args= */ NULL,
                         (char**) argv,
                         ge,
-                        EXEC_DIR_PARALLEL | EXEC_DIR_IGNORE_ERRORS | EXEC_DIR_SET_SYSTEMD_EXEC_PID | EXEC_DIR_WARN_WORLD_WRITABLE);
+                        EXEC_DIR_PARALLEL | EXEC_DIR_IGNORE_ERRORS | EXEC_DIR_SET_SYSTEMD_EXEC_PID | EXEC_DIR_WARN_WORLD_WRITABLE,
+                        timings_fd);
+}
+
+static void manager_read_generator_timings(Manager *m, int fd) {
+        ExecTiming *timings;
+        size_t n;
+        int r;
+
+        assert(m);
+        assert(fd >= 0);
+
+        r = exec_timings_read(fd, &timings, &n);
+        if (r < 0)
+                return (void) log_debug_errno(r, "Failed to read generator timings, ignoring: %m");
+
+        exec_timing_free_many(m->generator_timings, m->n_generator_timings);
+        m->generator_timings = timings;
+        m->n_generator_timings = n;
 }
 
 static int manager_run_generators(Manager *m) {
         ForkFlags flags = FORK_RESET_SIGNALS | FORK_WAIT | FORK_NEW_MOUNTNS | FORK_MOUNTNS_SLAVE;
         _cleanup_strv_free_ char **paths = NULL;
+        _cleanup_close_ int timings_fd = -EBADF;
         int r;
 
         assert(m);
@@ -4029,12 +4057,18 @@ static int manager_run_generators(Manager *m) {
                 goto finish;
         }
 
+        /* The generators are executed from a child process, which reports how long each of them ran
+         * through this file. */
+        timings_fd = open_serialization_fd("generator-timings");
+        if (timings_fd < 0)
+                log_debug_errno(timings_fd, "Failed to open generator timings file, ignoring: %m");
+
         /* If we are the system manager, we fork and invoke the generators in a sanitized mount namespace. If
          * we are the user manager, let's just execute the generators directly. We might not have the
          * necessary privileges, and the system manager has already mounted /tmp/ and everything else for us.
          */
         if (MANAGER_IS_USER(m)) {
-                r = manager_execute_generators(m, paths, /* remount_ro= */ false);
+                r = manager_execute_generators(m, paths, /* remount_ro= */ false, timings_fd);
                 goto finish;
         }
 
@@ -4045,7 +4079,7 @@ static int manager_run_generators(Manager *m) {
 
         r = safe_fork("(sd-gens)", flags, NULL);
         if (r == 0) {
-                r = manager_execute_generators(m, paths, /* remount_ro= */ true);
+                r = manager_execute_generators(m, paths, /* remount_ro= */ true, timings_fd);
                 _exit(r >= 0 ? EXIT_SUCCESS : EXIT_FAILURE);
         }
         if (r < 0) {
@@ -4066,11 +4100,15 @@ static int manager_run_generators(Manager *m) {
                 log_debug_errno(r,
                                 "Failed to fork off sandboxing environment for executing generators. "
                                 "Falling back to execute generators without sandboxing: %m");
-                r = manager_execute_generators(m, paths, /* remount_ro= */ false);
+                r = manager_execute_generators(m, paths, /* remount_ro= */ false, timings_fd);
         }
 
 finish:
         lookup_paths_trim_generator(&m->lookup_paths);
+
+        if (timings_fd >= 0)
+                manager_read_generator_timings(m, TAKE_FD(timings_fd));
+
         return r;
 }
 
@@ -11,6 +11,7 @@
 #include "common-signal.h"
 #include "cgroup-util.h"
 #include "cgroup.h"
+#include "exec-util.h"
 #include "fdset.h"
 #include "hashmap.h"
 #include "list.h"
@@ -289,6 +290,7 @@ struct Manager {
         Hashmap *unit_name_map;
         Set *unit_path_cache;
         uint64_t unit_cache_timestamp_hash;
+        uint64_t unit_cache_iteration; /* event loop iteration the timestamp hash was last checked in */
 
         /* We don't have support for atomically enabling/disabling units, and unit_file_state might become
          * outdated if such operations failed half-way. Therefore, we set this flag if changes to unit files
@@ -306,6 +308,10 @@ struct Manager {
 
         dual_timestamp timestamps[_MANAGER_TIMESTAMP_MAX];
 
+        /* How long each generator ran, the last time the generators were invoked */
+        ExecTiming *generator_timings;
+        size_t n_generator_timings;
+
         /* Data specific to the device subsystem */
         sd_device_monitor *device_monitor;
         Hashmap *devices_by_sysfs;
@@ -364,6 +370,11 @@ struct Manager {
         sd_event_source *cgroup_empty_event_source;
         sd_event_source *cgroup_oom_event_source;
 
+        /* Resource accounting data of all units, see manager_get_accounting_snapshot() */
+        UnitAccounting *accounting_snapshot;
+        size_t n_accounting_snapshot;
+        usec_t accounting_snapshot_timestamp;
+
         /* Make sure the user cannot accidentally unmount our cgroup
          * file system */
         int pin_cgroupfs_fd;
@@ -3,6 +3,7 @@
 #include "bpf-socket-bind.h"
 #include "bus-util.h"
 #include "dbus.h"
+#include "escape.h"
 #include "fileio-label.h"
 #include "fileio.h"
 #include "format-util.h"
@@ -191,6 +192,17 @@ int unit_serialize_state(Unit *u, FILE *f, FDSet *fds, bool switching_root) {
         (void) serialize_cgroup_mask(f, "cgroup-enabled-mask", u->cgroup_enabled_mask);
         (void) serialize_cgroup_mask(f, "cgroup-invalidated-mask", u->cgroup_invalidated_mask);
 
+        const char *attribute, *value;
+        HASHMAP_FOREACH_KEY(value, attribute, u->cgroup_attribute_cache) {
+                _cleanup_free_ char *escaped = NULL;
+
+                escaped = cescape(value);
+                if (!escaped)
+                        return log_oom();
+
+                (void) serialize_item_format(f, "cgroup-attribute", "%s %s", attribute, escaped);
+        }
+
         (void) bpf_serialize_socket_bind(u, f, fds);
 
         (void) bpf_program_serialize_attachment(f, fds, "ip-bpf-ingress-installed", u->ip_bpf_ingress_installed);
@@ -415,7 +427,30 @@ int unit_deserialize_state(Unit *u, FILE *f, FDSet *fds) {
                 else if (MATCH_DESERIALIZE_IMMEDIATE("cgroup-invalidated-mask", l, v, cg_mask_from_string, u->cgroup_invalidated_mask))
                         continue;
 
-                else if (STR_IN_SET(l, "ipv4-socket-bind-bpf-link-fd", "ipv6-socket-bind-bpf-link-fd")) {
+                else if (streq(l, "cgroup-attribute")) {
+                        _cleanup_free_ char *attribute = NULL, *value = NULL;
+                        const char *p = v;
+                        ssize_t k;
+
+                        r = extract_first_word(&p, &attribute, " ", 0);
+                        if (r <= 0 || isempty(p)) {
+                                log_unit_debug(u, "Failed to parse cgroup attribute cache entry '%s', ignoring.", v);
+                                continue;
+                        }
+
+                        k = cunescape(p, 0, &value);
+                        if (k < 0) {
+                                log_unit_debug_errno(u, k, "Failed to unescape cgroup attribute value '%s', ignoring: %m", p);
+                                continue;
+                        }
+
+                        r = unit_remember_cgroup_attribute(u, attribute, value);
+                        if (r < 0)
+                                log_unit_debug_errno(u, r, "Failed to remember value of cgroup attribute '%s', ignoring: %m", attribute);
+
+                        continue;
+
+                } else if (STR_IN_SET(l, "ipv4-socket-bind-bpf-link-fd", "ipv6-socket-bind-bpf-link-fd")) {
                         int fd;
 
                         fd = deserialize_fd(fds, v);
@@ -386,6 +386,11 @@ typedef struct Unit {
         CGroupMask cgroup_invalidated_mask;        /* A mask specifying controllers which shall be considered invalidated, and require re-realization */
         CGroupMask cgroup_members_mask;            /* A cache for the controllers required by all children of this cgroup (only relevant for slice units) */
 
+        /* The values we last wrote to the attributes of our cgroup, so that we can skip writing the same
+         * value again when the cgroup is realized anew, e.g. after a daemon reload. Maps attribute name →
+         * value. */
+        Hashmap *cgroup_attribute_cache;
+
         /* Inotify watch descriptors for watching cgroup.events and memory.events on cgroupv2 */
         int cgroup_control_inotify_wd;
         int cgroup_memory_inotify_wd;
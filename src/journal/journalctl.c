@@ -40,6 +40,7 @@
 #include "id128-print.h"
 #include "io-util.h"
 #include "journal-def.h"
+#include "journal-file-util.h"
 #include "journal-internal.h"
 #include "journal-util.h"
 #include "journal-vacuum.h"
@@ -171,6 +172,7 @@ static enum {
         ACTION_ROTATE,
         ACTION_VACUUM,
         ACTION_ROTATE_AND_VACUUM,
+        ACTION_COMPACT,
         ACTION_LIST_FIELDS,
         ACTION_LIST_FIELD_NAMES,
 } arg_action = ACTION_SHOW;
@@ -421,6 +423,7 @@ static int help(void) {
                "     --vacuum-size=BYTES     Reduce disk usage below specified size\n"
                "     --vacuum-files=INT      Leave only the specified number of journal files\n"
                "     --vacuum-time=TIME      Remove journal files older than specified time\n"
+               "     --compact               Rewrite archived journal files to use less space\n"
                "     --verify                Verify journal file consistency\n"
                "     --sync                  Synchronize unwritten journal messages to disk\n"
                "     --relinquish-var        Stop logging to disk, log to temporary file system\n"
@@ -485,6 +488,7 @@ static int parse_argv(int argc, char *argv[]) {
                 ARG_VACUUM_SIZE,
                 ARG_VACUUM_FILES,
                 ARG_VACUUM_TIME,
+                ARG_COMPACT,
                 ARG_NO_HOSTNAME,
                 ARG_OUTPUT_FIELDS,
                 ARG_NAMESPACE,
@@ -554,6 +558,7 @@ static int parse_argv(int argc, char *argv[]) {
                 { "vacuum-size",          required_argument, NULL, ARG_VACUUM_SIZE          },
                 { "vacuum-files",         required_argument, NULL, ARG_VACUUM_FILES         },
                 { "vacuum-time",          required_argument, NULL, ARG_VACUUM_TIME          },
+                { "compact",              no_argument,       NULL, ARG_COMPACT              },
                 { "no-hostname",          no_argument,       NULL, ARG_NO_HOSTNAME          },
                 { "output-fields",        required_argument, NULL, ARG_OUTPUT_FIELDS        },
                 { "namespace",            required_argument, NULL, ARG_NAMESPACE            },
@@ -811,6 +816,10 @@ static int parse_argv(int argc, char *argv[]) {
                         arg_action = arg_action == ACTION_ROTATE ? ACTION_ROTATE_AND_VACUUM : ACTION_VACUUM;
                         break;
 
+                case ARG_COMPACT:
+                        arg_action = ACTION_COMPACT;
+                        break;
+
 #if HAVE_GCRYPT
                 case ARG_FORCE:
                         arg_force = true;
@@ -1778,6 +1787,48 @@ static int setup_keys(void) {
 #endif
 }
 
+static int compact(sd_journal *j, bool verbose) {
+        uint64_t freed = 0;
+        JournalFile *f;
+        int r, ret = 0;
+
+        assert(j);
+
+        ORDERED_HASHMAP_FOREACH(f, j->files) {
+                uint64_t n = 0;
+
+                if (f->header->state != STATE_ARCHIVED) {
+                        log_debug("Not rewriting %s, journal file is not archived.", f->path);
+                        continue;
+                }
+
+                if (JOURNAL_HEADER_SEALED(f->header)) {
+                        log_full(verbose ? LOG_NOTICE : LOG_DEBUG,
+                                 "Not rewriting %s, journal file has sealing enabled.", f->path);
+                        continue;
+                }
+
+                r = journal_file_rewrite(f, JOURNAL_COMPRESS, UINT64_MAX, j->mmap, &n);
+                if (r < 0) {
+                        log_warning_errno(r, "Failed to rewrite %s: %m", f->path);
+                        if (ret >= 0)
+                                ret = r;
+                        continue;
+                }
+                if (r == 0)
+                        continue;
+
+                log_full(verbose ? LOG_INFO : LOG_DEBUG, "Rewrote archived journal %s, freed %s.",
+                         f->path, FORMAT_BYTES(n));
+                freed += n;
+        }
+
+        log_full(verbose ? LOG_INFO : LOG_DEBUG, "Compacting done, freed %s of archived journals.",
+                 FORMAT_BYTES(freed));
+
+        return ret;
+}
+
 static int verify(sd_journal *j, bool verbose) {
         int r = 0;
         JournalFile *f;
@@ -2273,6 +2324,7 @@ static int run(int argc, char *argv[]) {
         case ACTION_LIST_BOOTS:
         case ACTION_VACUUM:
         case ACTION_ROTATE_AND_VACUUM:
+        case ACTION_COMPACT:
         case ACTION_LIST_FIELDS:
         case ACTION_LIST_FIELD_NAMES:
                 /* These ones require access to the journal files, continue below. */
@@ -2365,6 +2417,9 @@ static int run(int argc, char *argv[]) {
                 return ret;
         }
 
+        case ACTION_COMPACT:
+                return compact(j, !arg_quiet);
+
         case ACTION_LIST_FIELD_NAMES: {
                 const char *field;
 
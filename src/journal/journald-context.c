@@ -142,6 +142,14 @@ static int client_context_new(Server *s, pid_t pid, ClientContext **ret) {
         return 0;
 }
 
+static void client_context_drop_meta_fields(ClientContext *c) {
+        assert(c);
+
+        c->meta_fields_iovec = mfree(c->meta_fields_iovec);
+        c->meta_fields_n_iovec = 0;
+        c->meta_fields_data = mfree(c->meta_fields_data);
+}
+
 static void client_context_reset(Server *s, ClientContext *c) {
         assert(s);
         assert(c);
@@ -177,6 +185,8 @@ static void client_context_reset(Server *s, ClientContext *c) {
         c->extra_fields_data = mfree(c->extra_fields_data);
         c->extra_fields_mtime = NSEC_INFINITY;
 
+        client_context_drop_meta_fields(c);
+
         c->log_level_max = -1;
 
         c->log_ratelimit_interval = s->ratelimit_interval;
@@ -536,6 +546,9 @@ static void client_context_really_refresh(
         (void) client_context_read_log_ratelimit_interval(c);
         (void) client_context_read_log_ratelimit_burst(c);
 
+        /* Everything might have changed, hence rebuild the fields on next use */
+        client_context_drop_meta_fields(c);
+
         c->timestamp = timestamp;
 
         if (c->in_lru) {
@@ -765,6 +778,117 @@ ClientContext *client_context_release(Server *s, ClientContext *c) {
         return NULL;
 }
 
+typedef struct MetaField {
+        const char *name;
+        const char *value;
+        size_t size;
+} MetaField;
+
+int client_context_get_meta_fields(ClientContext *c, const struct iovec **ret_iovec, size_t *ret_n_iovec) {
+        char pid[DECIMAL_STR_MAX(pid_t)], uid[DECIMAL_STR_MAX(uid_t)], gid[DECIMAL_STR_MAX(gid_t)],
+                auditid[DECIMAL_STR_MAX(uint32_t)], loginuid[DECIMAL_STR_MAX(uid_t)],
+                owner_uid[DECIMAL_STR_MAX(uid_t)], invocation_id[SD_ID128_STRING_MAX];
+        _cleanup_free_ struct iovec *iovec = NULL;
+        _cleanup_free_ char *data = NULL;
+        MetaField fields[N_IOVEC_OBJECT_FIELDS];
+        size_t n = 0, size = 0;
+        char *p;
+
+        assert(c);
+        assert(ret_iovec);
+        assert(ret_n_iovec);
+
+        /* Returns the metadata fields of the context, i.e. _PID=, _COMM=, _SYSTEMD_UNIT= and so on. These are
+         * attached to every single message of the client, hence format them only once instead of for every
+         * message, and keep them until the context is refreshed. */
+
+        if (c->meta_fields_data)
+                goto finish;
+
+#define ADD_META_FIELD(_name, _value, _size)                                    \
+        do {                                                                    \
+                assert(n < ELEMENTSOF(fields));                                 \
+                fields[n++] = (MetaField) {                                     \
+                        .name = _name,                                          \
+                        .value = _value,                                        \
+                        .size = _size,                                          \
+                };                                                              \
+        } while (false)
+
+        if (pid_is_valid(c->pid))
+                ADD_META_FIELD("_PID=", pid, sprintf(pid, PID_FMT, c->pid));
+        if (uid_is_valid(c->uid))
+                ADD_META_FIELD("_UID=", uid, sprintf(uid, UID_FMT, c->uid));
+        if (gid_is_valid(c->gid))
+                ADD_META_FIELD("_GID=", gid, sprintf(gid, GID_FMT, c->gid));
+
+        if (!isempty(c->comm)) /* At most TASK_COMM_LENGTH (16 bytes) */
+                ADD_META_FIELD("_COMM=", c->comm, strlen(c->comm));
+        if (!isempty(c->exe)) /* A path, so at most PATH_MAX (4096 bytes) */
+                ADD_META_FIELD("_EXE=", c->exe, strlen(c->exe));
+        if (c->cmdline) /* At most _SC_ARG_MAX (2MB usually) */
+                ADD_META_FIELD("_CMDLINE=", c->cmdline, strlen(c->cmdline));
+
+        if (!isempty(c->capeff)) /* Read from /proc/.../status */
+                ADD_META_FIELD("_CAP_EFFECTIVE=", c->capeff, strlen(c->capeff));
+        if (c->label_size > 0)
+                ADD_META_FIELD("_SELINUX_CONTEXT=", c->label, c->label_size);
+        if (audit_session_is_valid(c->auditid))
+                ADD_META_FIELD("_AUDIT_SESSION=", auditid, sprintf(auditid, "%" PRIu32, c->auditid));
+        if (uid_is_valid(c->loginuid))
+                ADD_META_FIELD("_AUDIT_LOGINUID=", loginuid, sprintf(loginuid, UID_FMT, c->loginuid));
+
+        if (!isempty(c->cgroup)) /* A path */
+                ADD_META_FIELD("_SYSTEMD_CGROUP=", c->cgroup, strlen(c->cgroup));
+        if (!isempty(c->session))
+                ADD_META_FIELD("_SYSTEMD_SESSION=", c->session, strlen(c->session));
+        if (uid_is_valid(c->owner_uid))
+                ADD_META_FIELD("_SYSTEMD_OWNER_UID=", owner_uid, sprintf(owner_uid, UID_FMT, c->owner_uid));
+        if (!isempty(c->unit)) /* Unit names are bounded by UNIT_NAME_MAX */
+                ADD_META_FIELD("_SYSTEMD_UNIT=", c->unit, strlen(c->unit));
+        if (!isempty(c->user_unit))
+                ADD_META_FIELD("_SYSTEMD_USER_UNIT=", c->user_unit, strlen(c->user_unit));
+        if (!isempty(c->slice))
+                ADD_META_FIELD("_SYSTEMD_SLICE=", c->slice, strlen(c->slice));
+        if (!isempty(c->user_slice))
+                ADD_META_FIELD("_SYSTEMD_USER_SLICE=", c->user_slice, strlen(c->user_slice));
+
+        if (!sd_id128_is_null(c->invocation_id))
+                ADD_META_FIELD("_SYSTEMD_INVOCATION_ID=", sd_id128_to_string(c->invocation_id, invocation_id),
+                               SD_ID128_STRING_MAX - 1);
+
+#undef ADD_META_FIELD
+
+        /* Put all fields into a single allocation, like we do for the extra fields */
+        FOREACH_ARRAY(f, fields, n)
+                size += strlen(f->name) + f->size + 1;
+
+        iovec = new(struct iovec, MAX(n, 1u));
+        data = new(char, MAX(size, 1u));
+        if (!iovec || !data)
+                return -ENOMEM;
+
+        p = data;
+        for (size_t i = 0; i < n; i++) {
+                char *k = p;
+
+                p = stpcpy(p, fields[i].name);
+                p = mempcpy(p, fields[i].value, fields[i].size);
+                *(p++) = 0;
+
+                iovec[i] = IOVEC_MAKE(k, p - k - 1);
+        }
+
+        c->meta_fields_iovec = TAKE_PTR(iovec);
+        c->meta_fields_n_iovec = n;
+        c->meta_fields_data = TAKE_PTR(data);
+
+finish:
+        *ret_iovec = c->meta_fields_iovec;
+        *ret_n_iovec = c->meta_fields_n_iovec;
+        return 0;
+}
+
 void client_context_acquire_default(Server *s) {
         int r;
 
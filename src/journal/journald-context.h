@@ -54,6 +54,12 @@ struct ClientContext {
         void *extra_fields_data;
         nsec_t extra_fields_mtime;
 
+        /* The _PID=, _COMM=, … fields formatted from the above, built on first use and dropped whenever the
+         * context is refreshed */
+        struct iovec *meta_fields_iovec;
+        size_t meta_fields_n_iovec;
+        void *meta_fields_data;
+
         usec_t log_ratelimit_interval;
         unsigned log_ratelimit_burst;
 
@@ -87,6 +93,8 @@ void client_context_maybe_refresh(
                 const char *unit_id,
                 usec_t tstamp);
 
+int client_context_get_meta_fields(ClientContext *c, const struct iovec **ret_iovec, size_t *ret_n_iovec);
+
 void client_context_acquire_default(Server *s);
 void client_context_flush_all(Server *s);
 void client_context_flush_regular(Server *s);
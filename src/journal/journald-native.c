@@ -93,7 +93,7 @@ static void server_process_entry_meta(
 
 static int server_process_entry(
                 Server *s,
-                const void *buffer, size_t *remaining,
+                void *buffer, size_t *remaining,
                 ClientContext *context,
                 const struct ucred *ucred,
                 const struct timeval *tv,
@@ -102,20 +102,22 @@ static int server_process_entry(
         /* Process a single entry from a native message. Returns 0 if nothing special happened and the message
          * processing should continue, and a negative or positive value otherwise.
          *
-         * Note that *remaining is altered on both success and failure. */
+         * Note that *remaining is altered on both success and failure. Binary fields are rewritten in place
+         * in the buffer, so that all iovecs can point into it and no field needs to be copied before it is
+         * written to the journal. */
 
-        size_t n = 0, j, tn = SIZE_MAX, entry_size = 0;
+        size_t n = 0, entry_size = 0;
         char *identifier = NULL, *message = NULL;
         struct iovec *iovec = NULL;
         int priority = LOG_INFO;
         pid_t object_pid = 0;
-        const char *p;
+        char *p;
         int r = 1;
 
         p = buffer;
 
         while (*remaining > 0) {
-                const char *e, *q;
+                char *e, *q;
 
                 e = memchr(p, '\n', *remaining);
 
@@ -213,28 +215,24 @@ static int server_process_entry(
                                 break;
                         }
 
-                        k = malloc(total);
-                        if (!k) {
-                                log_oom();
-                                break;
-                        }
-
-                        memcpy(k, p, e - p);
-                        k[e - p] = '=';
-                        memcpy(k + (e - p) + 1, e + 1 + sizeof(uint64_t), l);
-
                         if (journal_field_valid(p, e - p, false)) {
-                                iovec[n] = IOVEC_MAKE(k, (e - p) + 1 + l);
+                                /* Turn "NAME\n<le64 size><data>" into "NAME=<data>" by moving the field name
+                                 * (which is short) right in front of the data (which might be large), so
+                                 * that we can reference the field without copying it. The size has been
+                                 * read already, hence it's fine to overwrite it. */
+                                k = memmove(p + sizeof(uint64_t), p, e - p);
+                                k[e - p] = '=';
+
+                                iovec[n] = IOVEC_MAKE(k, total);
                                 entry_size += iovec[n].iov_len;
                                 n++;
 
-                                server_process_entry_meta(k, (e - p) + 1 + l, ucred,
+                                server_process_entry_meta(k, total, ucred,
                                                           &priority,
                                                           &identifier,
                                                           &message,
                                                           &object_pid);
-                        } else
-                                free(k);
+                        }
 
                         *remaining -= (e - p) + 1 + sizeof(uint64_t) + l + 1;
                         p = e + 1 + sizeof(uint64_t) + l + 1;
@@ -244,8 +242,7 @@ static int server_process_entry(
         if (n <= 0)
                 goto finish;
 
-        tn = n++;
-        iovec[tn] = IOVEC_MAKE_STRING("_TRANSPORT=journal");
+        iovec[n++] = IOVEC_MAKE_STRING("_TRANSPORT=journal");
         entry_size += STRLEN("_TRANSPORT=journal");
 
         if (entry_size + n + 1 > ENTRY_SIZE_MAX) { /* data + separators + trailer */
@@ -282,15 +279,6 @@ static int server_process_entry(
         server_dispatch_message(s, iovec, n, MALLOC_ELEMENTSOF(iovec), context, tv, priority, object_pid);
 
 finish:
-        for (j = 0; j < n; j++)  {
-                if (j == tn)
-                        continue;
-
-                if (iovec[j].iov_base < buffer ||
-                    (const char*) iovec[j].iov_base >= p + *remaining)
-                        free(iovec[j].iov_base);
-        }
-
         free(iovec);
         free(identifier);
         free(message);
@@ -300,7 +288,7 @@ finish:
 
 void server_process_native_message(
                 Server *s,
-                const char *buffer, size_t buffer_size,
+                char *buffer, size_t buffer_size,
                 const struct ucred *ucred,
                 const struct timeval *tv,
                 const char *label, size_t label_len) {
@@ -322,7 +310,7 @@ void server_process_native_message(
 
         do {
                 r = server_process_entry(s,
-                                         (const uint8_t*) buffer + (buffer_size - remaining), &remaining,
+                                         buffer + (buffer_size - remaining), &remaining,
                                          context, ucred, tv, label, label_len);
         } while (r == 0);
 }
@@ -413,11 +401,13 @@ void server_process_native_file(
                 void *p;
                 size_t ps;
 
-                /* The file is sealed, we can just map it and use it. */
+                /* The file is sealed, we can just map it and use it. The mapping is private and writable,
+                 * since binary fields are rewritten in place while parsing: this only copies the pages
+                 * touched, and never the sender's memfd itself. */
 
                 ps = PAGE_ALIGN(st.st_size);
                 assert(ps < SIZE_MAX);
-                p = mmap(NULL, ps, PROT_READ, MAP_PRIVATE, fd, 0);
+                p = mmap(NULL, ps, PROT_READ|PROT_WRITE, MAP_PRIVATE, fd, 0);
                 if (p == MAP_FAILED) {
                         log_ratelimit_error_errno(errno, JOURNAL_LOG_RATELIMIT,
                                                   "Failed to map memfd, ignoring: %m");
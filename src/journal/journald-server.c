@@ -19,6 +19,7 @@
 #include "cgroup-util.h"
 #include "conf-parser.h"
 #include "dirent-util.h"
+#include "event-util.h"
 #include "extract-word.h"
 #include "fd-util.h"
 #include "fileio.h"
@@ -87,6 +88,10 @@
 
 #define FAILED_TO_WRITE_ENTRY_RATELIMIT ((const RateLimit) { .interval = 1 * USEC_PER_SEC, .burst = 1 })
 
+/* Number of already pending event sources (i.e. log streams and sockets with data) that are dispatched in a
+ * row before checking for new events again */
+#define EVENT_DISPATCH_BUDGET 16
+
 static int server_determine_path_usage(
                 Server *s,
                 const char *path,
@@ -1032,13 +1037,13 @@ static void server_write_to_journal(
 static void server_dispatch_message_real(
                 Server *s,
                 struct iovec *iovec, size_t n, size_t m,
-                const ClientContext *c,
+                ClientContext *c,
                 const struct timeval *tv,
                 int priority,
                 pid_t object_pid) {
 
         char source_time[sizeof("_SOURCE_REALTIME_TIMESTAMP=") + DECIMAL_STR_MAX(usec_t)];
-        _unused_ _cleanup_free_ char *cmdline1 = NULL, *cmdline2 = NULL;
+        _unused_ _cleanup_free_ char *cmdline = NULL;
         uid_t journal_uid;
         ClientContext *o;
 
@@ -1050,33 +1055,21 @@ static void server_dispatch_message_real(
                (pid_is_valid(object_pid) ? N_IOVEC_OBJECT_FIELDS : 0) +
                client_context_extra_fields_n_iovec(c) <= m);
 
-        if (c) {
-                IOVEC_ADD_NUMERIC_FIELD(iovec, n, c->pid, pid_t, pid_is_valid, PID_FMT, "_PID");
-                IOVEC_ADD_NUMERIC_FIELD(iovec, n, c->uid, uid_t, uid_is_valid, UID_FMT, "_UID");
-                IOVEC_ADD_NUMERIC_FIELD(iovec, n, c->gid, gid_t, gid_is_valid, GID_FMT, "_GID");
-
-                IOVEC_ADD_STRING_FIELD(iovec, n, c->comm, "_COMM"); /* At most TASK_COMM_LENGTH (16 bytes) */
-                IOVEC_ADD_STRING_FIELD(iovec, n, c->exe, "_EXE"); /* A path, so at most PATH_MAX (4096 bytes) */
-
-                if (c->cmdline)
-                        /* At most _SC_ARG_MAX (2MB usually), which is too much to put on stack.
-                         * Let's use a heap allocation for this one. */
-                        cmdline1 = set_iovec_string_field(iovec, &n, "_CMDLINE=", c->cmdline);
-
-                IOVEC_ADD_STRING_FIELD(iovec, n, c->capeff, "_CAP_EFFECTIVE"); /* Read from /proc/.../status */
-                IOVEC_ADD_SIZED_FIELD(iovec, n, c->label, c->label_size, "_SELINUX_CONTEXT");
-                IOVEC_ADD_NUMERIC_FIELD(iovec, n, c->auditid, uint32_t, audit_session_is_valid, "%" PRIu32, "_AUDIT_SESSION");
-                IOVEC_ADD_NUMERIC_FIELD(iovec, n, c->loginuid, uid_t, uid_is_valid, UID_FMT, "_AUDIT_LOGINUID");
+        /* Look up the object's context first, as that might refresh 'c' if both refer to the same process,
+         * which would invalidate the meta fields of 'c' we reference below. */
+        if (!pid_is_valid(object_pid) || client_context_get(s, object_pid, NULL, NULL, 0, NULL, &o) < 0)
+                o = NULL;
 
-                IOVEC_ADD_STRING_FIELD(iovec, n, c->cgroup, "_SYSTEMD_CGROUP"); /* A path */
-                IOVEC_ADD_STRING_FIELD(iovec, n, c->session, "_SYSTEMD_SESSION");
-                IOVEC_ADD_NUMERIC_FIELD(iovec, n, c->owner_uid, uid_t, uid_is_valid, UID_FMT, "_SYSTEMD_OWNER_UID");
-                IOVEC_ADD_STRING_FIELD(iovec, n, c->unit, "_SYSTEMD_UNIT"); /* Unit names are bounded by UNIT_NAME_MAX */
-                IOVEC_ADD_STRING_FIELD(iovec, n, c->user_unit, "_SYSTEMD_USER_UNIT");
-                IOVEC_ADD_STRING_FIELD(iovec, n, c->slice, "_SYSTEMD_SLICE");
-                IOVEC_ADD_STRING_FIELD(iovec, n, c->user_slice, "_SYSTEMD_USER_SLICE");
-
-                IOVEC_ADD_ID128_FIELD(iovec, n, c->invocation_id, "_SYSTEMD_INVOCATION_ID");
+        if (c) {
+                const struct iovec *meta;
+                size_t n_meta;
+
+                if (client_context_get_meta_fields(c, &meta, &n_meta) < 0)
+                        log_oom_debug();
+                else {
+                        memcpy(iovec + n, meta, n_meta * sizeof(struct iovec));
+                        n += n_meta;
+                }
 
                 if (c->extra_fields_n_iovec > 0) {
                         memcpy(iovec + n, c->extra_fields_iovec, c->extra_fields_n_iovec * sizeof(struct iovec));
@@ -1086,7 +1079,7 @@ static void server_dispatch_message_real(
 
         assert(n <= m);
 
-        if (pid_is_valid(object_pid) && client_context_get(s, object_pid, NULL, NULL, 0, NULL, &o) >= 0) {
+        if (o) {
 
                 IOVEC_ADD_NUMERIC_FIELD(iovec, n, o->pid, pid_t, pid_is_valid, PID_FMT, "OBJECT_PID");
                 IOVEC_ADD_NUMERIC_FIELD(iovec, n, o->uid, uid_t, uid_is_valid, UID_FMT, "OBJECT_UID");
@@ -1096,7 +1089,7 @@ static void server_dispatch_message_real(
                 IOVEC_ADD_STRING_FIELD(iovec, n, o->comm, "OBJECT_COMM");
                 IOVEC_ADD_STRING_FIELD(iovec, n, o->exe, "OBJECT_EXE");
                 if (o->cmdline)
-                        cmdline2 = set_iovec_string_field(iovec, &n, "OBJECT_CMDLINE=", o->cmdline);
+                        cmdline = set_iovec_string_field(iovec, &n, "OBJECT_CMDLINE=", o->cmdline);
 
                 IOVEC_ADD_STRING_FIELD(iovec, n, o->capeff, "OBJECT_CAP_EFFECTIVE");
                 IOVEC_ADD_SIZED_FIELD(iovec, n, o->label, o->label_size, "OBJECT_SELINUX_CONTEXT");
@@ -2553,6 +2546,10 @@ int server_init(Server *s, const char *namespace) {
         if (r < 0)
                 return log_error_errno(r, "Failed to create event loop: %m");
 
+        r = event_set_dispatch_budget(s->event, EVENT_DISPATCH_BUDGET);
+        if (r < 0)
+                return log_error_errno(r, "Failed to set event loop dispatch budget: %m");
+
         n = sd_listen_fds(true);
         if (n < 0)
                 return log_error_errno(n, "Failed to read listening file descriptors from environment: %m");
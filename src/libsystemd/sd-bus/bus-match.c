@@ -52,10 +52,16 @@ static bool BUS_MATCH_IS_COMPARE(enum bus_match_node_type t) {
         return t >= BUS_MATCH_SENDER && t <= BUS_MATCH_ARG_HAS_LAST;
 }
 
+static bool BUS_MATCH_IS_SIMPLE_NAMESPACE(enum bus_match_node_type t) {
+        return t == BUS_MATCH_PATH_NAMESPACE ||
+                (t >= BUS_MATCH_ARG_NAMESPACE && t <= BUS_MATCH_ARG_NAMESPACE_LAST);
+}
+
 static bool BUS_MATCH_CAN_HASH(enum bus_match_node_type t) {
         return (t >= BUS_MATCH_MESSAGE_TYPE && t <= BUS_MATCH_PATH) ||
                 (t >= BUS_MATCH_ARG && t <= BUS_MATCH_ARG_LAST) ||
-                (t >= BUS_MATCH_ARG_HAS && t <= BUS_MATCH_ARG_HAS_LAST);
+                (t >= BUS_MATCH_ARG_HAS && t <= BUS_MATCH_ARG_HAS_LAST) ||
+                BUS_MATCH_IS_SIMPLE_NAMESPACE(t);
 }
 
 static void bus_match_node_free(struct bus_match_node *node) {
@@ -235,6 +241,60 @@ static bool value_node_same(
         }
 }
 
+static int bus_match_run_namespace(
+                sd_bus *bus,
+                struct bus_match_node *node,
+                const char *value,
+                sd_bus_message *m) {
+
+        _cleanup_free_ char *prefix = NULL;
+        char separator;
+        size_t n;
+        int r;
+
+        assert(node);
+        assert(BUS_MATCH_IS_SIMPLE_NAMESPACE(node->type));
+
+        if (!value)
+                return 0;
+
+        /* A namespace pattern matches a value if it is the value itself, or a prefix of it that is either
+         * followed by a separator in the value or ends in one, see simple_pattern_check(). Hence, instead
+         * of testing every value node, look up each such prefix of the value in the hash table. */
+
+        separator = node->type == BUS_MATCH_PATH_NAMESPACE ? '/' : '.';
+
+        prefix = strdup(value);
+        if (!prefix)
+                return -ENOMEM;
+
+        n = strlen(prefix);
+        for (size_t l = 0; l <= n; l++) {
+                struct bus_match_node *found;
+                char c;
+
+                if (l < n && value[l] != separator && (l == 0 || value[l-1] != separator))
+                        continue;
+
+                c = prefix[l];
+                prefix[l] = 0;
+                found = hashmap_get(node->compare.children, prefix);
+                prefix[l] = c;
+
+                if (!found)
+                        continue;
+
+                r = bus_match_run(bus, found, m);
+                if (r != 0)
+                        return r;
+
+                if (bus && bus->match_callbacks_modified)
+                        return 0;
+        }
+
+        return 0;
+}
+
 int bus_match_run(
                 sd_bus *bus,
                 struct bus_match_node *node,
@@ -380,7 +440,13 @@ int bus_match_run(
 
                 /* Lookup via hash table, nice! So let's jump directly. */
 
-                if (test_str)
+                if (BUS_MATCH_IS_SIMPLE_NAMESPACE(node->type)) {
+                        r = bus_match_run_namespace(bus, node, test_str, m);
+                        if (r != 0)
+                                return r;
+
+                        found = NULL;
+                } else if (test_str)
                         found = hashmap_get(node->compare.children, test_str);
                 else if (test_strv) {
                         STRV_FOREACH(i, test_strv) {
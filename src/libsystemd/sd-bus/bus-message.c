@@ -96,17 +96,58 @@ static struct bus_container *message_get_last_container(sd_bus_message *m) {
         return m->containers + m->n_containers - 1;
 }
 
+static char* message_container_signature_new(sd_bus_message *m, const char *contents) {
+        char *s;
+
+        assert(m);
+        assert(contents);
+
+        /* Sibling containers usually share the same signature (think the elements of an array of structs),
+         * hence reuse the signature of the container most recently closed at this nesting level, if it
+         * matches, instead of allocating a new copy for each container. */
+
+        if (m->n_containers < m->n_container_signatures) {
+                s = m->container_signatures[m->n_containers];
+                if (s && streq(s, contents)) {
+                        m->container_signatures[m->n_containers] = NULL;
+                        return s;
+                }
+        }
+
+        return strdup(contents);
+}
+
+static void message_container_signature_free(sd_bus_message *m, size_t depth, char *s) {
+        assert(m);
+
+        if (!s)
+                return;
+
+        if (depth >= m->n_container_signatures) {
+                if (!GREEDY_REALLOC0(m->container_signatures, depth + 1)) {
+                        free(s);
+                        return;
+                }
+
+                m->n_container_signatures = MALLOC_ELEMENTSOF(m->container_signatures);
+        }
+
+        free_and_replace(m->container_signatures[depth], s);
+}
+
 static void message_free_last_container(sd_bus_message *m) {
         struct bus_container *c;
 
         c = message_get_last_container(m);
 
-        free(c->signature);
         free(c->peeked_signature);
 
         /* Move to previous container, but not if we are on root container */
-        if (m->n_containers > 0)
+        if (m->n_containers > 0) {
                 m->n_containers--;
+                message_container_signature_free(m, m->n_containers, c->signature);
+        } else
+                free(c->signature);
 }
 
 static void message_reset_containers(sd_bus_message *m) {
@@ -142,6 +183,9 @@ static sd_bus_message* message_free(sd_bus_message *m) {
         assert(m->n_containers == 0);
         message_free_last_container(m);
 
+        free_many_charp(m->container_signatures, m->n_container_signatures);
+        free(m->container_signatures);
+
         bus_creds_done(&m->creds);
         return mfree(m);
 }
@@ -1766,7 +1810,7 @@ _public_ int sd_bus_message_open_container(
 
         c = message_get_last_container(m);
 
-        signature = strdup(contents);
+        signature = message_container_signature_new(m, contents);
         if (!signature) {
                 m->poisoned = true;
                 return -ENOMEM;
@@ -1818,7 +1862,7 @@ _public_ int sd_bus_message_close_container(sd_bus_message *m) {
 
         m->n_containers--;
 
-        free(c->signature);
+        message_container_signature_free(m, m->n_containers, c->signature);
 
         return 0;
 }
@@ -2206,7 +2250,7 @@ _public_ int sd_bus_message_append_array_memfd(
 
         copy_fd = fcntl(memfd, F_DUPFD_CLOEXEC, 3);
         if (copy_fd < 0)
-                return copy_fd;
+                return -errno;
 
         r = memfd_get_size(memfd, &real_size);
         if (r < 0)
@@ -2279,9 +2323,9 @@ _public_ int sd_bus_message_append_string_memfd(
         if (r < 0)
                 return r;
 
-        copy_fd = fcntl(memfd, FD_CLOEXEC, 3);
+        copy_fd = fcntl(memfd, F_DUPFD_CLOEXEC, 3);
         if (copy_fd < 0)
-                return copy_fd;
+                return -errno;
 
         r = memfd_get_size(memfd, &real_size);
         if (r < 0)
@@ -3098,7 +3142,7 @@ _public_ int sd_bus_message_enter_container(sd_bus_message *m,
 
         c = message_get_last_container(m);
 
-        signature = strdup(contents);
+        signature = message_container_signature_new(m, contents);
         if (!signature)
                 return -ENOMEM;
 
@@ -4267,10 +4311,12 @@ _public_ int sd_bus_message_set_sender(sd_bus_message *m, const char *sender) {
 }
 
 int bus_message_get_blob(sd_bus_message *m, void **buffer, size_t *sz) {
+        _cleanup_free_ void *p = NULL;
         size_t total;
-        void *p, *e;
+        void *e;
         size_t i;
         struct bus_body_part *part;
+        int r;
 
         assert(m);
         assert(buffer);
@@ -4283,12 +4329,18 @@ int bus_message_get_blob(sd_bus_message *m, void **buffer, size_t *sz) {
                 return -ENOMEM;
 
         e = mempcpy(p, m->header, BUS_MESSAGE_BODY_BEGIN(m));
-        MESSAGE_FOREACH_PART(part, i, m)
-                e = mempcpy(e, part->data, part->size);
+        MESSAGE_FOREACH_PART(part, i, m) {
+                /* Parts backed by a memfd are not mapped until needed */
+                r = bus_body_part_map(part);
+                if (r < 0)
+                        return r;
+
+                e = mempcpy_safe(e, part->data, part->size);
+        }
 
         assert(total == (size_t) ((uint8_t*) e - (uint8_t*) p));
 
-        *buffer = p;
+        *buffer = TAKE_PTR(p);
         *sz = total;
 
         return 0;
@@ -102,6 +102,10 @@ struct sd_bus_message {
         struct bus_container root_container, *containers;
         size_t n_containers;
 
+        /* Signatures of the containers last closed at each nesting level, kept around for reuse */
+        char **container_signatures;
+        size_t n_container_signatures;
+
         struct iovec *iovec;
         struct iovec iovec_fixed[2];
         unsigned n_iovec;
@@ -1,5 +1,7 @@
 /* SPDX-License-Identifier: LGPL-2.1-or-later */
 
+#include <fcntl.h>
+#include <pthread.h>
 #include <sys/wait.h>
 #include <unistd.h>
 
@@ -8,15 +10,24 @@
 #include "alloc-util.h"
 #include "bus-internal.h"
 #include "bus-kernel.h"
+#include "bus-match.h"
+#include "bus-slot.h"
 #include "constants.h"
 #include "fd-util.h"
+#include "json.h"
 #include "missing_resource.h"
 #include "string-util.h"
+#include "strv.h"
 #include "tests.h"
 #include "time-util.h"
+#include "varlink.h"
 
 #define MAX_SIZE (2*1024*1024)
 
+/* Shape of the objects and replies used by the "suite" benchmarks, modelled after what PID 1 exposes */
+#define SUITE_N_PROPERTIES 256
+#define SUITE_N_UNITS 256
+
 static usec_t arg_loop_usec = 100 * USEC_PER_MSEC;
 
 typedef enum Type {
@@ -206,10 +217,403 @@ static void client_chart(Type type, const char *address, const char *server_name
         sd_bus_unref(b);
 }
 
+static int match_filter(sd_bus_message *m, void *userdata, sd_bus_error *ret_error) {
+        size_t *hits = ASSERT_PTR(userdata);
+
+        (*hits)++;
+        return 0;
+}
+
+static void benchmark_match(void) {
+        _cleanup_close_pair_ int pair[2] = EBADF_PAIR;
+        _cleanup_(sd_bus_message_unrefp) sd_bus_message *m = NULL;
+        _cleanup_(sd_bus_unrefp) sd_bus *b = NULL;
+
+        /* Measures how the cost of dispatching a message to the match callbacks scales with the number of
+         * installed matches, of which only a single one matches the message. */
+
+        assert_se(socketpair(AF_UNIX, SOCK_STREAM, 0, pair) >= 0);
+        assert_se(sd_bus_new(&b) >= 0);
+        assert_se(sd_bus_set_fd(b, pair[0], pair[0]) >= 0);
+        TAKE_FD(pair[0]);
+        assert_se(sd_bus_start(b) >= 0);
+
+        assert_se(sd_bus_message_new_signal(b, &m, "/org/example/object/7/child", "org.example.Iface", "Changed") >= 0);
+        assert_se(sd_bus_message_append(m, "s", "org.example.name7.sub") >= 0);
+        assert_se(sd_bus_message_seal(m, 1, 0) >= 0);
+
+        FOREACH_STRING(kind, "path_namespace", "arg0namespace", "path", "arg0") {
+                for (size_t n = 1; n <= 10000; n *= 10) {
+                        struct bus_match_node root = {
+                                .type = BUS_MATCH_ROOT,
+                        };
+                        _cleanup_free_ sd_bus_slot *slots = NULL;
+                        size_t hits = 0, runs = 0;
+                        usec_t t;
+
+                        assert_se(slots = new0(sd_bus_slot, n));
+
+                        for (size_t i = 0; i < n; i++) {
+                                struct bus_match_component *components = NULL;
+                                size_t n_components = 0;
+                                _cleanup_free_ char *match = NULL;
+
+                                CLEANUP_ARRAY(components, n_components, bus_match_parse_free);
+
+                                if (streq(kind, "path_namespace"))
+                                        assert_se(asprintf(&match, "path_namespace='/org/example/object/%zu'", i) >= 0);
+                                else if (streq(kind, "arg0namespace"))
+                                        assert_se(asprintf(&match, "arg0namespace='org.example.name%zu'", i) >= 0);
+                                else if (streq(kind, "path"))
+                                        assert_se(asprintf(&match, "path='/org/example/object/%zu/child'", i) >= 0);
+                                else
+                                        assert_se(asprintf(&match, "arg0='org.example.name%zu.sub'", i) >= 0);
+
+                                assert_se(bus_match_parse(match, &components, &n_components) >= 0);
+
+                                slots[i].userdata = &hits;
+                                slots[i].match_callback.callback = match_filter;
+                                assert_se(bus_match_add(&root, components, n_components, &slots[i].match_callback) >= 0);
+                        }
+
+                        t = now(CLOCK_MONOTONIC);
+                        do {
+                                for (unsigned j = 0; j < 1000; j++)
+                                        assert_se(bus_match_run(NULL, &root, m) == 0);
+                                runs += 1000;
+                        } while (now(CLOCK_MONOTONIC) < t + arg_loop_usec);
+                        t = now(CLOCK_MONOTONIC) - t;
+
+                        assert_se(hits == (n > 7 ? runs : 0));
+
+                        printf("%-14s %6zu matches: %10.1f messages/s\n",
+                               kind, n, (double) runs * USEC_PER_SEC / t);
+
+                        bus_match_free(&root);
+                }
+        }
+}
+
+typedef struct SuiteServer {
+        int fd;
+        char **property_names;
+} SuiteServer;
+
+typedef struct SuiteContext {
+        sd_bus *bus;
+        Varlink *link;
+        sd_bus_message *units;
+        int devnull_fd;
+} SuiteContext;
+
+static bool suite_property_is_number(const char *name) {
+        /* Half of the properties are numbers, the other half strings */
+        return name[strlen(name) - 1] % 2 == 0;
+}
+
+static int suite_property_get(
+                sd_bus *bus,
+                const char *path,
+                const char *interface,
+                const char *property,
+                sd_bus_message *reply,
+                void *userdata,
+                sd_bus_error *error) {
+
+        if (suite_property_is_number(property))
+                return sd_bus_message_append(reply, "t", UINT64_C(4711));
+
+        return sd_bus_message_append(reply, "s", property);
+}
+
+static int suite_method_ping(sd_bus_message *m, void *userdata, sd_bus_error *error) {
+        return sd_bus_reply_method_return(m, NULL);
+}
+
+static int suite_method_pass_fd(sd_bus_message *m, void *userdata, sd_bus_error *error) {
+        int fd;
+
+        assert_se(sd_bus_message_read(m, "h", &fd) > 0);
+        assert_se(fd >= 0);
+
+        return sd_bus_reply_method_return(m, NULL);
+}
+
+static int suite_method_exit(sd_bus_message *m, void *userdata, sd_bus_error *error) {
+        bool *done = ASSERT_PTR(userdata);
+
+        *done = true;
+        return sd_bus_reply_method_return(m, NULL);
+}
+
+static void* suite_bus_server(void *p) {
+        SuiteServer *server = ASSERT_PTR(p);
+        _cleanup_free_ sd_bus_vtable *vtable = NULL;
+        _cleanup_(sd_bus_flush_close_unrefp) sd_bus *b = NULL;
+        size_t k = 0;
+        bool done = false;
+        int r;
+
+        assert_se(vtable = new(sd_bus_vtable, SUITE_N_PROPERTIES + 5));
+        vtable[k++] = (sd_bus_vtable) SD_BUS_VTABLE_START(0);
+        vtable[k++] = (sd_bus_vtable) SD_BUS_METHOD("Ping", NULL, NULL, suite_method_ping, 0);
+        vtable[k++] = (sd_bus_vtable) SD_BUS_METHOD("PassFD", "h", NULL, suite_method_pass_fd, 0);
+        vtable[k++] = (sd_bus_vtable) SD_BUS_METHOD("Exit", NULL, NULL, suite_method_exit, 0);
+        STRV_FOREACH(name, server->property_names)
+                vtable[k++] = (sd_bus_vtable) SD_BUS_PROPERTY(*name, suite_property_is_number(*name) ? "t" : "s", suite_property_get, 0, 0);
+        vtable[k++] = (sd_bus_vtable) SD_BUS_VTABLE_END;
+
+        assert_se(sd_bus_new(&b) >= 0);
+        assert_se(sd_bus_set_fd(b, server->fd, server->fd) >= 0);
+        assert_se(sd_bus_set_server(b, true, SD_ID128_NULL) >= 0);
+        assert_se(sd_bus_start(b) >= 0);
+
+        assert_se(sd_bus_add_object_vtable(b, NULL, "/benchmark", "benchmark.server", vtable, &done) >= 0);
+
+        while (!done) {
+                r = sd_bus_process(b, NULL);
+                assert_se(r >= 0);
+                if (r == 0)
+                        assert_se(sd_bus_wait(b, USEC_INFINITY) >= 0);
+        }
+
+        return NULL;
+}
+
+static int suite_vl_method_ping(Varlink *link, JsonVariant *parameters, VarlinkMethodFlags flags, void *userdata) {
+        return varlink_reply(link, NULL);
+}
+
+static int suite_vl_method_pass_fd(Varlink *link, JsonVariant *parameters, VarlinkMethodFlags flags, void *userdata) {
+        assert_se(varlink_peek_fd(link, 0) >= 0);
+
+        return varlink_reply(link, NULL);
+}
+
+static int suite_vl_method_get_all(Varlink *link, JsonVariant *parameters, VarlinkMethodFlags flags, void *userdata) {
+        _cleanup_(json_variant_unrefp) JsonVariant *v = NULL;
+        char **names = ASSERT_PTR(userdata);
+        JsonVariant **array = NULL;
+        size_t k = 0;
+        int r;
+
+        CLEANUP_ARRAY(array, k, json_variant_unref_many);
+
+        /* The Varlink equivalent of the GetAll() call on the bus object, with properties of the same types */
+
+        assert_se(array = new(JsonVariant*, strv_length(names) * 2));
+
+        STRV_FOREACH(name, names) {
+                assert_se(json_variant_new_string(array + k++, *name) >= 0);
+
+                if (suite_property_is_number(*name))
+                        r = json_variant_new_unsigned(array + k++, 4711);
+                else
+                        r = json_variant_new_string(array + k++, *name);
+                assert_se(r >= 0);
+        }
+
+        assert_se(json_variant_new_object(&v, array, k) >= 0);
+
+        return varlink_reply(link, v);
+}
+
+static void* suite_varlink_server(void *p) {
+        SuiteServer *server = ASSERT_PTR(p);
+        _cleanup_(varlink_server_unrefp) VarlinkServer *s = NULL;
+        _cleanup_(sd_event_unrefp) sd_event *e = NULL;
+        Varlink *link;
+
+        assert_se(sd_event_new(&e) >= 0);
+
+        assert_se(varlink_server_new(&s, VARLINK_SERVER_INHERIT_USERDATA) >= 0);
+        varlink_server_set_userdata(s, server->property_names);
+        assert_se(varlink_server_bind_method(s, "io.systemd.Benchmark.Ping", suite_vl_method_ping) >= 0);
+        assert_se(varlink_server_bind_method(s, "io.systemd.Benchmark.PassFD", suite_vl_method_pass_fd) >= 0);
+        assert_se(varlink_server_bind_method(s, "io.systemd.Benchmark.GetAll", suite_vl_method_get_all) >= 0);
+        assert_se(varlink_server_attach_event(s, e, 0) >= 0);
+
+        assert_se(varlink_server_add_connection(s, server->fd, &link) >= 0);
+        assert_se(varlink_set_allow_fd_passing_input(link, true) >= 0);
+
+        /* Exit as soon as the client disconnects */
+        assert_se(varlink_server_set_exit_on_idle(s, true) >= 0);
+
+        assert_se(sd_event_loop(e) >= 0);
+
+        return NULL;
+}
+
+static void suite_marshal(SuiteContext *c) {
+        _cleanup_(sd_bus_message_unrefp) sd_bus_message *m = NULL;
+
+        assert_se(sd_bus_message_new_method_call(c->bus, &m, NULL, "/", "benchmark.server", "Units") >= 0);
+        assert_se(sd_bus_message_open_container(m, 'a', "(ssssssouso)") >= 0);
+        for (unsigned i = 0; i < SUITE_N_UNITS; i++)
+                assert_se(sd_bus_message_append(
+                                          m, "(ssssssouso)",
+                                          "foobar.service",
+                                          "Some longish description of the foobar service",
+                                          "loaded",
+                                          "active",
+                                          "running",
+                                          "",
+                                          "/org/freedesktop/systemd1/unit/foobar_2eservice",
+                                          i,
+                                          "start",
+                                          "/org/freedesktop/systemd1/job/4711") >= 0);
+        assert_se(sd_bus_message_close_container(m) >= 0);
+        assert_se(sd_bus_message_seal(m, 1, 0) >= 0);
+
+        if (!c->units)
+                c->units = TAKE_PTR(m);
+}
+
+static void suite_unmarshal(SuiteContext *c) {
+        const char *id, *description, *load_state, *active_state, *sub_state, *following, *unit_path, *job_type, *job_path;
+        unsigned n = 0;
+        uint32_t job_id;
+        int r;
+
+        assert_se(sd_bus_message_rewind(c->units, true) >= 0);
+        assert_se(sd_bus_message_enter_container(c->units, 'a', "(ssssssouso)") > 0);
+        while ((r = sd_bus_message_read(
+                                c->units, "(ssssssouso)",
+                                &id, &description, &load_state, &active_state, &sub_state, &following,
+                                &unit_path, &job_id, &job_type, &job_path)) > 0)
+                n++;
+        assert_se(r == 0);
+        assert_se(sd_bus_message_exit_container(c->units) >= 0);
+        assert_se(n == SUITE_N_UNITS);
+}
+
+static void suite_bus_ping(SuiteContext *c) {
+        assert_se(sd_bus_call_method(c->bus, NULL, "/benchmark", "benchmark.server", "Ping", NULL, NULL, NULL) >= 0);
+}
+
+static void suite_bus_get_all(SuiteContext *c) {
+        _cleanup_(sd_bus_message_unrefp) sd_bus_message *reply = NULL;
+
+        assert_se(sd_bus_call_method(c->bus, NULL, "/benchmark", "org.freedesktop.DBus.Properties", "GetAll",
+                                     NULL, &reply, "s", "benchmark.server") >= 0);
+        assert_se(sd_bus_message_skip(reply, "a{sv}") >= 0);
+}
+
+static void suite_bus_pass_fd(SuiteContext *c) {
+        assert_se(sd_bus_call_method(c->bus, NULL, "/benchmark", "benchmark.server", "PassFD", NULL, NULL,
+                                     "h", c->devnull_fd) >= 0);
+}
+
+static void suite_varlink_ping(SuiteContext *c) {
+        JsonVariant *reply;
+        const char *error_id;
+
+        assert_se(varlink_call(c->link, "io.systemd.Benchmark.Ping", NULL, &reply, &error_id, NULL) >= 0);
+        assert_se(!error_id);
+}
+
+static void suite_varlink_get_all(SuiteContext *c) {
+        JsonVariant *reply;
+        const char *error_id;
+
+        assert_se(varlink_call(c->link, "io.systemd.Benchmark.GetAll", NULL, &reply, &error_id, NULL) >= 0);
+        assert_se(!error_id);
+        assert_se(json_variant_elements(reply) == SUITE_N_PROPERTIES * 2);
+}
+
+static void suite_varlink_pass_fd(SuiteContext *c) {
+        JsonVariant *reply;
+        const char *error_id;
+        int fd;
+
+        assert_se((fd = fcntl(c->devnull_fd, F_DUPFD_CLOEXEC, 3)) >= 0);
+        assert_se(varlink_push_fd(c->link, fd) >= 0);
+
+        assert_se(varlink_call(c->link, "io.systemd.Benchmark.PassFD", NULL, &reply, &error_id, NULL) >= 0);
+        assert_se(!error_id);
+}
+
+static void suite_run(const char *name, void (*f)(SuiteContext *c), SuiteContext *c) {
+        uint64_t n = 0;
+        usec_t t;
+
+        t = now(CLOCK_MONOTONIC);
+        do {
+                for (unsigned i = 0; i < 10; i++)
+                        f(c);
+                n += 10;
+        } while (now(CLOCK_MONOTONIC) < t + arg_loop_usec);
+        t = now(CLOCK_MONOTONIC) - t;
+
+        printf("%s\t%" PRIu64 "\t%" PRIu64 "\t%.3f\n", name, n, n * USEC_PER_SEC / t, (double) t / n);
+}
+
+static void benchmark_suite(void) {
+        _cleanup_close_pair_ int bus_pair[2] = EBADF_PAIR, varlink_pair[2] = EBADF_PAIR;
+        _cleanup_strv_free_ char **names = NULL;
+        SuiteServer bus_server, varlink_server;
+        pthread_t bus_thread, varlink_thread;
+        _cleanup_close_ int devnull_fd = -EBADF;
+        SuiteContext c = {};
+
+        /* Measures the IPC hot paths of PID 1 over direct connections, for sd-bus and the equivalent
+         * Varlink calls. Results are printed as tab separated values, one benchmark per line. */
+
+        for (unsigned i = 0; i < SUITE_N_PROPERTIES; i++)
+                assert_se(strv_extendf(&names, "Property%u", i) >= 0);
+
+        assert_se((devnull_fd = open("/dev/null", O_RDONLY|O_CLOEXEC)) >= 0);
+        c.devnull_fd = devnull_fd;
+
+        assert_se(socketpair(AF_UNIX, SOCK_STREAM|SOCK_CLOEXEC, 0, bus_pair) >= 0);
+        bus_server = (SuiteServer) {
+                .fd = TAKE_FD(bus_pair[1]),
+                .property_names = names,
+        };
+        assert_se(pthread_create(&bus_thread, NULL, suite_bus_server, &bus_server) == 0);
+
+        assert_se(sd_bus_new(&c.bus) >= 0);
+        assert_se(sd_bus_set_fd(c.bus, bus_pair[0], bus_pair[0]) >= 0);
+        TAKE_FD(bus_pair[0]);
+        assert_se(sd_bus_start(c.bus) >= 0);
+
+        assert_se(socketpair(AF_UNIX, SOCK_STREAM|SOCK_CLOEXEC|SOCK_NONBLOCK, 0, varlink_pair) >= 0);
+        varlink_server = (SuiteServer) {
+                .fd = TAKE_FD(varlink_pair[1]),
+                .property_names = names,
+        };
+        assert_se(pthread_create(&varlink_thread, NULL, suite_varlink_server, &varlink_server) == 0);
+
+        assert_se(varlink_connect_fd(&c.link, varlink_pair[0]) >= 0);
+        TAKE_FD(varlink_pair[0]);
+        assert_se(varlink_set_allow_fd_passing_output(c.link, true) >= 0);
+
+        printf("BENCHMARK\tITERATIONS\tOPS/S\tUSEC/OP\n");
+
+        suite_run("bus-marshal-list-units", suite_marshal, &c);
+        suite_run("bus-unmarshal-list-units", suite_unmarshal, &c);
+        suite_run("bus-ping", suite_bus_ping, &c);
+        suite_run("bus-get-all", suite_bus_get_all, &c);
+        suite_run("bus-pass-fd", suite_bus_pass_fd, &c);
+        suite_run("varlink-ping", suite_varlink_ping, &c);
+        suite_run("varlink-get-all", suite_varlink_get_all, &c);
+        suite_run("varlink-pass-fd", suite_varlink_pass_fd, &c);
+
+        assert_se(sd_bus_call_method(c.bus, NULL, "/benchmark", "benchmark.server", "Exit", NULL, NULL, NULL) >= 0);
+        c.bus = sd_bus_flush_close_unref(c.bus);
+        c.link = varlink_flush_close_unref(c.link);
+        c.units = sd_bus_message_unref(c.units);
+
+        assert_se(pthread_join(bus_thread, NULL) == 0);
+        assert_se(pthread_join(varlink_thread, NULL) == 0);
+}
+
 int main(int argc, char *argv[]) {
         enum {
                 MODE_BISECT,
                 MODE_CHART,
+                MODE_MATCH,
+                MODE_SUITE,
         } mode = MODE_BISECT;
         Type type = TYPE_LEGACY;
         int i, pair[2] = EBADF_PAIR;
@@ -228,6 +632,12 @@ int main(int argc, char *argv[]) {
                 if (streq(argv[i], "chart")) {
                         mode = MODE_CHART;
                         continue;
+                } else if (streq(argv[i], "match")) {
+                        mode = MODE_MATCH;
+                        continue;
+                } else if (streq(argv[i], "suite")) {
+                        mode = MODE_SUITE;
+                        continue;
                 } else if (streq(argv[i], "legacy")) {
                         type = TYPE_LEGACY;
                         continue;
@@ -241,6 +651,16 @@ int main(int argc, char *argv[]) {
 
         assert_se(arg_loop_usec > 0);
 
+        if (mode == MODE_MATCH) {
+                benchmark_match();
+                return 0;
+        }
+
+        if (mode == MODE_SUITE) {
+                benchmark_suite();
+                return 0;
+        }
+
         if (type == TYPE_LEGACY) {
                 const char *e;
 
@@ -303,6 +723,10 @@ int main(int argc, char *argv[]) {
                 case MODE_CHART:
                         client_chart(type, address, server_name, pair[1]);
                         break;
+
+                case MODE_MATCH:
+                case MODE_SUITE:
+                        assert_not_reached();
                 }
 
                 _exit(EXIT_SUCCESS);
@@ -22,6 +22,7 @@
 #include "fd-util.h"
 #include "fileio.h"
 #include "log.h"
+#include "memfd-util.h"
 #include "memstream-util.h"
 #include "tests.h"
 
@@ -107,6 +108,84 @@ static void test_bus_label_escape(void) {
         test_bus_label_escape_one(":1", "_3a1");
 }
 
+static void test_bus_append_memfd(sd_bus *bus) {
+        _cleanup_(sd_bus_message_unrefp) sd_bus_message *m = NULL;
+        _cleanup_close_ int array_fd = -EBADF, string_fd = -EBADF;
+        const char *str = "a string passed in a memfd", *x, *y;
+        _cleanup_free_ uint8_t *data = NULL;
+        void *buffer = NULL;
+        size_t n, sz;
+        const void *p;
+
+        n = 3 * page_size() + 17;
+        assert_se(data = new(uint8_t, n));
+        for (size_t i = 0; i < n; i++)
+                data[i] = i % 251;
+
+        assert_se((array_fd = memfd_new_and_seal("test-bus-marshal", data, n)) >= 0);
+        assert_se((string_fd = memfd_new_and_seal("test-bus-marshal", str, strlen(str) + 1)) >= 0);
+
+        assert_se(sd_bus_message_new_method_call(bus, &m, "foobar.waldo", "/", "foobar.waldo", "Memfd") >= 0);
+        assert_se(sd_bus_message_append_array_memfd(m, 'y', array_fd, 0, UINT64_MAX) >= 0);
+        assert_se(sd_bus_message_append_string_memfd(m, string_fd, 0, UINT64_MAX) >= 0);
+        assert_se(sd_bus_message_append(m, "s", "after") >= 0);
+        assert_se(sd_bus_message_seal(m, 4712, 0) >= 0);
+
+        /* The message keeps its own references to the memfds */
+        array_fd = safe_close(array_fd);
+        string_fd = safe_close(string_fd);
+
+        assert_se(bus_message_get_blob(m, &buffer, &sz) >= 0);
+        m = sd_bus_message_unref(m);
+
+        assert_se(bus_message_from_malloc(bus, buffer, sz, NULL, 0, NULL, &m) >= 0);
+
+        assert_se(sd_bus_message_read_array(m, 'y', &p, &sz) > 0);
+        assert_se(sz == n);
+        assert_se(memcmp(p, data, n) == 0);
+
+        assert_se(sd_bus_message_read(m, "ss", &x, &y) > 0);
+        assert_se(streq(x, str));
+        assert_se(streq(y, "after"));
+}
+
+static void test_bus_container_signatures(sd_bus *bus) {
+        _cleanup_(sd_bus_message_unrefp) sd_bus_message *m = NULL;
+        const char *s;
+        uint32_t u;
+
+        /* Sibling containers at the same nesting level reuse each other's signatures, make sure this
+         * works when the signatures alternate between siblings, too. */
+
+        assert_se(sd_bus_message_new_method_call(bus, &m, "foobar.waldo", "/", "foobar.waldo", "Containers") >= 0);
+        assert_se(sd_bus_message_open_container(m, 'a', "v") >= 0);
+        for (unsigned i = 0; i < 64; i++)
+                if (i % 3 == 0)
+                        assert_se(sd_bus_message_append(m, "v", "(su)", "foo", i) >= 0);
+                else
+                        assert_se(sd_bus_message_append(m, "v", "(us)", i, "bar") >= 0);
+        assert_se(sd_bus_message_close_container(m) >= 0);
+        assert_se(sd_bus_message_seal(m, 4713, 0) >= 0);
+
+        for (unsigned k = 0; k < 2; k++) {
+                assert_se(sd_bus_message_enter_container(m, 'a', "v") > 0);
+                for (unsigned i = 0; i < 64; i++) {
+                        if (i % 3 == 0) {
+                                assert_se(sd_bus_message_read(m, "v", "(su)", &s, &u) > 0);
+                                assert_se(streq(s, "foo"));
+                        } else {
+                                assert_se(sd_bus_message_read(m, "v", "(us)", &u, &s) > 0);
+                                assert_se(streq(s, "bar"));
+                        }
+                        assert_se(u == i);
+                }
+                assert_se(sd_bus_message_exit_container(m) >= 0);
+                assert_se(sd_bus_message_at_end(m, true) > 0);
+
+                assert_se(sd_bus_message_rewind(m, true) >= 0);
+        }
+}
+
 int main(int argc, char *argv[]) {
         _cleanup_(sd_bus_message_unrefp) sd_bus_message *m = NULL, *copy = NULL;
         _cleanup_free_ char *h = NULL, *first = NULL, *second = NULL, *third = NULL;
@@ -413,6 +492,8 @@ int main(int argc, char *argv[]) {
         test_bus_path_encode();
         test_bus_path_encode_unique();
         test_bus_path_encode_many();
+        test_bus_append_memfd(bus);
+        test_bus_container_signatures(bus);
 
         return 0;
 }
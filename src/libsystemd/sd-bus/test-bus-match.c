@@ -73,7 +73,7 @@ int main(int argc, char *argv[]) {
 
         _cleanup_(sd_bus_message_unrefp) sd_bus_message *m = NULL;
         _cleanup_(sd_bus_flush_close_unrefp) sd_bus *bus = NULL;
-        sd_bus_slot slots[19] = {};
+        sd_bus_slot slots[23] = {};
         int r;
 
         test_setup_logging(LOG_INFO);
@@ -102,6 +102,10 @@ int main(int argc, char *argv[]) {
         assert_se(match_add(slots, &root, "arg4has='pa'", 16) >= 0);
         assert_se(match_add(slots, &root, "arg4has='po'", 17) >= 0);
         assert_se(match_add(slots, &root, "arg4='pi'", 18) >= 0);
+        assert_se(match_add(slots, &root, "path_namespace='/'", 19) >= 0);
+        assert_se(match_add(slots, &root, "path_namespace='/foo/ba'", 20) >= 0);
+        assert_se(match_add(slots, &root, "arg3namespace='prefix.four'", 21) >= 0);
+        assert_se(match_add(slots, &root, "arg3namespace='prefix.fo'", 22) >= 0);
 
         bus_match_dump(stdout, &root, 0);
 
@@ -111,7 +115,7 @@ int main(int argc, char *argv[]) {
 
         zero(mask);
         assert_se(bus_match_run(NULL, &root, m) == 0);
-        assert_se(mask_contains((unsigned[]) { 9, 8, 7, 5, 10, 12, 13, 14, 15, 16, 17 }, 11));
+        assert_se(mask_contains((unsigned[]) { 9, 8, 7, 5, 10, 12, 13, 14, 15, 16, 17, 19, 21 }, 13));
 
         assert_se(bus_match_remove(&root, &slots[8].match_callback) >= 0);
         assert_se(bus_match_remove(&root, &slots[13].match_callback) >= 0);
@@ -120,7 +124,7 @@ int main(int argc, char *argv[]) {
 
         zero(mask);
         assert_se(bus_match_run(NULL, &root, m) == 0);
-        assert_se(mask_contains((unsigned[]) { 9, 5, 10, 12, 14, 7, 15, 16, 17 }, 9));
+        assert_se(mask_contains((unsigned[]) { 9, 5, 10, 12, 14, 7, 15, 16, 17, 19, 21 }, 11));
 
         for (enum bus_match_node_type i = 0; i < _BUS_MATCH_NODE_TYPE_MAX; i++) {
                 char buf[32];
@@ -78,6 +78,16 @@ struct sd_event_source {
 
         RateLimit rate_limit;
 
+        /* Dispatch statistics, only maintained if profiling is enabled */
+        struct {
+                uint64_t n_dispatched;
+                usec_t dispatch_usec;
+                usec_t dispatch_max_usec;
+                usec_t cpu_usec;
+                usec_t latency_max_usec;
+                usec_t pending_usec; /* when the source was last marked pending */
+        } stats;
+
         /* These are primarily fields relevant for time event sources, but since any event source can
          * effectively become one when rate-limited, this is part of the common fields. */
         unsigned earliest_index;
@@ -89,8 +99,11 @@ struct sd_event_source {
                         int fd;
                         uint32_t events;
                         uint32_t revents;
+                        LIST_FIELDS(sd_event_source, unregister_list);
                         bool registered:1;
                         bool owned:1;
+                        bool in_unregister_list:1;
+                        bool disarmed:1;
                 } io;
                 struct {
                         sd_event_time_handler_t callback;
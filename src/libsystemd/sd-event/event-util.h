@@ -32,3 +32,17 @@ static inline int event_source_disable(sd_event_source *s) {
 }
 
 int event_add_time_change(sd_event *e, sd_event_source **ret, sd_event_io_handler_t callback, void *userdata);
+
+/* Only available if profiling is enabled via $SD_EVENT_PROFILE_DELAYS, returns -ENODATA otherwise */
+int event_source_get_statistics(
+                sd_event_source *s,
+                uint64_t *ret_n_dispatched,
+                uint64_t *ret_dispatch_usec,
+                uint64_t *ret_dispatch_max_usec,
+                uint64_t *ret_cpu_usec,
+                uint64_t *ret_latency_max_usec);
+
+/* Allows dispatching up to the given number of already pending event sources in a row, before checking for
+ * new events again. 0 or 1 restores the default of checking before every dispatch. */
+int event_set_dispatch_budget(sd_event *e, unsigned budget);
+int event_get_dispatch_budget(sd_event *e, unsigned *ret);
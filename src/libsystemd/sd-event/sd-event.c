@@ -12,6 +12,7 @@
 #include "alloc-util.h"
 #include "env-util.h"
 #include "event-source.h"
+#include "event-util.h"
 #include "fd-util.h"
 #include "fs-util.h"
 #include "glyph-util.h"
@@ -145,6 +146,9 @@ struct sd_event {
         /* A list of memory pressure event sources that still need their subscription string written */
         LIST_HEAD(sd_event_source, memory_pressure_write_list);
 
+        /* A list of disabled ONESHOT IO event sources, whose fd is still in the epoll, but disarmed */
+        LIST_HEAD(sd_event_source, io_unregister_list);
+
         uint64_t origin_id;
 
         uint64_t iteration;
@@ -165,6 +169,11 @@ struct sd_event {
 
         unsigned n_sources;
 
+        /* How many pending event sources to dispatch at most before checking for new events again, and
+         * how many we dispatched so far since we last checked */
+        unsigned dispatch_budget;
+        unsigned n_dispatched_without_wait;
+
         struct epoll_event *event_queue;
 
         LIST_HEAD(sd_event_source, sources);
@@ -296,6 +305,18 @@ static int time_prioq_compare(const void *a, const void *b, usec_t (*time_func)(
         if (r != 0)
                 return r;
 
+        /* Disabled ones are only looked at to leave the ratelimited state, hence the order of the others
+         * doesn't matter. Consider them all equal, so that changing their time doesn't require reordering
+         * the prioqs. */
+        if (x->enabled == SD_EVENT_OFF) {
+                r = CMP(!x->ratelimited, !y->ratelimited);
+                if (r != 0)
+                        return r;
+
+                if (!x->ratelimited)
+                        return 0;
+        }
+
         /* Order "non-pending OR ratelimited" before "pending AND not-ratelimited" */
         r = CMP(!event_source_timer_candidate(x), !event_source_timer_candidate(y));
         if (r != 0)
@@ -429,7 +450,7 @@ _public_ int sd_event_new(sd_event** ret) {
         e->epoll_fd = fd_move_above_stdio(e->epoll_fd);
 
         if (secure_getenv("SD_EVENT_PROFILE_DELAYS")) {
-                log_debug("Event loop profiling enabled. Logarithmic histogram of event loop iterations in the range 2^0 %s 2^63 us will be logged every 5s.",
+                log_debug("Event loop profiling enabled. Logarithmic histogram of event loop iterations in the range 2^0 %s 2^63 us and dispatch statistics of event sources will be logged every 5s.",
                           special_glyph(SPECIAL_GLYPH_ELLIPSIS));
                 e->profile_delays = true;
         }
@@ -476,10 +497,23 @@ _public_ sd_event_source* sd_event_source_disable_unref(sd_event_source *s) {
         return sd_event_source_unref(s);
 }
 
+static void source_io_remove_from_unregister_list(sd_event_source *s) {
+        assert(s);
+        assert(s->type == SOURCE_IO);
+
+        if (!s->io.in_unregister_list)
+                return;
+
+        LIST_REMOVE(io.unregister_list, s->event->io_unregister_list, s);
+        s->io.in_unregister_list = false;
+}
+
 static void source_io_unregister(sd_event_source *s) {
         assert(s);
         assert(s->type == SOURCE_IO);
 
+        source_io_remove_from_unregister_list(s);
+
         if (event_origin_changed(s->event))
                 return;
 
@@ -491,6 +525,43 @@ static void source_io_unregister(sd_event_source *s) {
                                 strna(s->description), event_source_type_to_string(s->type));
 
         s->io.registered = false;
+        s->io.disarmed = false;
+}
+
+static void source_io_unregister_later(sd_event_source *s) {
+        assert(s);
+        assert(s->type == SOURCE_IO);
+
+        /* ONESHOT sources are disabled after being dispatched, and are usually enabled again by their
+         * callback or soon after. Since the kernel already disabled the fd in the epoll when reporting the
+         * event, it won't report any further events for it, hence there's no need to remove it from the
+         * epoll right away. Keep it registered, so that enabling the source again is a single
+         * EPOLL_CTL_MOD instead of an EPOLL_CTL_DEL + EPOLL_CTL_ADD pair. Any other source is removed
+         * immediately, since the fd might be closed once the source is disabled. */
+
+        if (!s->io.disarmed) {
+                source_io_unregister(s);
+                return;
+        }
+
+        if (!s->io.registered || s->io.in_unregister_list)
+                return;
+
+        LIST_PREPEND(io.unregister_list, s->event->io_unregister_list, s);
+        s->io.in_unregister_list = true;
+}
+
+static void event_flush_io_unregister_list(sd_event *e) {
+        sd_event_source *s;
+
+        assert(e);
+
+        /* Called before any fd is added to the epoll, since the fd of a disabled source might have been
+         * closed and its number reused in the meantime, in which case removing it later would remove the
+         * wrong registration. */
+
+        while ((s = e->io_unregister_list))
+                source_io_unregister(s);
 }
 
 static int source_io_register(
@@ -507,12 +578,31 @@ static int source_io_register(
                 .data.ptr = s,
         };
 
-        if (epoll_ctl(s->event->epoll_fd,
-                      s->io.registered ? EPOLL_CTL_MOD : EPOLL_CTL_ADD,
-                      s->io.fd, &ev) < 0)
+        source_io_remove_from_unregister_list(s);
+
+        if (s->io.registered) {
+                if (epoll_ctl(s->event->epoll_fd, EPOLL_CTL_MOD, s->io.fd, &ev) >= 0)
+                        goto done;
+
+                /* If the source was kept registered while disabled (see source_io_unregister_later()), the
+                 * callback might have closed the fd in the meantime and gotten the same fd number back for
+                 * a different file. The registration of the old file is gone then, or at least is not
+                 * found under this fd anymore, hence add the fd anew. */
+                if (!s->io.disarmed || !IN_SET(errno, ENOENT, EBADF))
+                        return -errno;
+
+                s->io.registered = false;
+        }
+
+        event_flush_io_unregister_list(s->event);
+
+        if (epoll_ctl(s->event->epoll_fd, EPOLL_CTL_ADD, s->io.fd, &ev) < 0)
                 return -errno;
 
+done:
+
         s->io.registered = true;
+        s->io.disarmed = false;
 
         return 0;
 }
@@ -546,6 +636,9 @@ static int source_child_pidfd_register(sd_event_source *s, int enabled) {
                         .data.ptr = s,
                 };
 
+                if (!s->child.registered)
+                        event_flush_io_unregister_list(s->event);
+
                 if (epoll_ctl(s->event->epoll_fd,
                               s->child.registered ? EPOLL_CTL_MOD : EPOLL_CTL_ADD,
                               s->child.pidfd, &ev) < 0)
@@ -584,6 +677,9 @@ static int source_memory_pressure_register(sd_event_source *s, int enabled) {
                 .data.ptr = s,
         };
 
+        if (!s->memory_pressure.registered)
+                event_flush_io_unregister_list(s->event);
+
         if (epoll_ctl(s->event->epoll_fd,
                       s->memory_pressure.registered ? EPOLL_CTL_MOD : EPOLL_CTL_ADD,
                       s->memory_pressure.fd, &ev) < 0)
@@ -773,6 +869,8 @@ static int event_make_signal_data(
                 .data.ptr = d,
         };
 
+        event_flush_io_unregister_list(e);
+
         if (epoll_ctl(e->epoll_fd, EPOLL_CTL_ADD, d->fd, &ev) < 0) {
                 r = -errno;
                 goto fail;
@@ -876,6 +974,15 @@ static void event_source_pp_prioq_reshuffle(sd_event_source *s) {
                 prioq_reshuffle(s->event->prepare, s, &s->prepare_index);
 }
 
+static bool event_source_time_matters(const sd_event_source *s) {
+        assert(s);
+        assert(EVENT_SOURCE_IS_TIME(s->type));
+
+        /* Returns false if the time and accuracy of a time event source currently have no effect on its
+         * position in the prioqs, see time_prioq_compare() and time_event_source_next(). */
+        return s->enabled != SD_EVENT_OFF && !s->ratelimited;
+}
+
 static void event_source_time_prioq_reshuffle(sd_event_source *s) {
         struct clock_data *d;
 
@@ -1140,6 +1247,9 @@ static int source_set_pending(sd_event_source *s, bool b) {
         if (b) {
                 s->pending_iteration = s->event->iteration;
 
+                if (s->event->profile_delays)
+                        s->stats.pending_usec = now(CLOCK_MONOTONIC);
+
                 r = prioq_put(s->event->pending, s, &s->pending_index);
                 if (r < 0) {
                         s->pending = false;
@@ -1319,6 +1429,8 @@ static int event_setup_timer_fd(
                 .data.ptr = d,
         };
 
+        event_flush_io_unregister_list(e);
+
         if (epoll_ctl(e->epoll_fd, EPOLL_CTL_ADD, fd, &ev) < 0)
                 return -errno;
 
@@ -2200,6 +2312,8 @@ static int event_make_inotify_data(
                 .data.ptr = d,
         };
 
+        event_flush_io_unregister_list(e);
+
         if (epoll_ctl(e->epoll_fd, EPOLL_CTL_ADD, d->fd, &ev) < 0) {
                 r = -errno;
                 d->fd = safe_close(d->fd); /* let's close this ourselves, as event_free_inotify_data() would otherwise
@@ -2644,8 +2758,18 @@ _public_ int sd_event_source_set_io_fd(sd_event_source *s, int fd) {
         assert_return(s->type == SOURCE_IO, -EDOM);
         assert_return(!event_origin_changed(s->event), -ECHILD);
 
-        if (s->io.fd == fd)
+        if (s->io.fd == fd) {
+                /* The caller might have closed the old fd and gotten the same number back for a new file,
+                 * hence don't keep a deferred registration of the old file around. */
+                if (s->io.in_unregister_list)
+                        source_io_unregister(s);
+
                 return 0;
+        }
+
+        /* If the source is disabled, but the old fd is still in the epoll, remove it now */
+        if (event_source_is_offline(s))
+                source_io_unregister(s);
 
         saved_fd = s->io.fd;
         s->io.fd = fd;
@@ -2896,7 +3020,7 @@ static int event_source_offline(
         switch (s->type) {
 
         case SOURCE_IO:
-                source_io_unregister(s);
+                source_io_unregister_later(s);
                 break;
 
         case SOURCE_SIGNAL:
@@ -3107,7 +3231,8 @@ _public_ int sd_event_source_set_time(sd_event_source *s, uint64_t usec) {
 
         s->time.next = usec;
 
-        event_source_time_prioq_reshuffle(s);
+        if (event_source_time_matters(s))
+                event_source_time_prioq_reshuffle(s);
         return 0;
 }
 
@@ -3161,7 +3286,8 @@ _public_ int sd_event_source_set_time_accuracy(sd_event_source *s, uint64_t usec
 
         s->time.accuracy = usec;
 
-        event_source_time_prioq_reshuffle(s);
+        if (event_source_time_matters(s))
+                event_source_time_prioq_reshuffle(s);
         return 0;
 }
 
@@ -3599,6 +3725,10 @@ static int process_io(sd_event *e, sd_event_source *s, uint32_t revents) {
         assert(s);
         assert(s->type == SOURCE_IO);
 
+        /* The kernel disabled the fd in the epoll when reporting the event, see source_io_unregister_later() */
+        if (s->enabled == SD_EVENT_ONESHOT)
+                s->io.disarmed = true;
+
         /* If the event source was already pending, we just OR in the
          * new revents, otherwise we reset the value. The ORing is
          * necessary to handle EPOLLONESHOT events properly where
@@ -3685,6 +3815,31 @@ static int process_timer(
         return callback_invoked;
 }
 
+static int process_timers(sd_event *e) {
+        int r;
+
+        assert(e);
+
+        r = process_timer(e, e->timestamp.realtime, &e->realtime);
+        if (r < 0)
+                return r;
+
+        r = process_timer(e, e->timestamp.boottime, &e->boottime);
+        if (r < 0)
+                return r;
+
+        r = process_timer(e, e->timestamp.realtime, &e->realtime_alarm);
+        if (r < 0)
+                return r;
+
+        r = process_timer(e, e->timestamp.boottime, &e->boottime_alarm);
+        if (r < 0)
+                return r;
+
+        /* Only CLOCK_MONOTONIC timers may invoke a ratelimit expiry callback, see sd_event_wait(). */
+        return process_timer(e, e->timestamp.monotonic, &e->monotonic);
+}
+
 static int process_child(sd_event *e, int64_t threshold, int64_t *ret_min_priority) {
         int64_t min_priority = threshold;
         bool something_new = false;
@@ -4115,7 +4270,34 @@ static int source_memory_pressure_initiate_dispatch(sd_event_source *s) {
         return 0; /* go on, dispatch to user callback */
 }
 
+static void source_account_dispatch(sd_event_source *s, usec_t begin, usec_t begin_cpu) {
+        usec_t d;
+
+        assert(s);
+
+        d = usec_sub_unsigned(now(CLOCK_MONOTONIC), begin);
+
+        s->stats.n_dispatched++;
+        s->stats.dispatch_usec = usec_add(s->stats.dispatch_usec, d);
+        s->stats.dispatch_max_usec = MAX(s->stats.dispatch_max_usec, d);
+        s->stats.cpu_usec = usec_add(s->stats.cpu_usec, usec_sub_unsigned(now(CLOCK_THREAD_CPUTIME_ID), begin_cpu));
+}
+
+static void source_account_latency(sd_event_source *s, usec_t begin) {
+        assert(s);
+
+        /* Defer sources stay pending while enabled, there's no meaningful latency for them */
+        if (!IN_SET(s->type, SOURCE_DEFER, SOURCE_EXIT) && s->stats.pending_usec != 0)
+                s->stats.latency_max_usec = MAX(s->stats.latency_max_usec,
+                                                usec_sub_unsigned(begin, s->stats.pending_usec));
+
+        /* Consume the timestamp before the callback is invoked, so that if the callback marks the source
+         * pending again, that is accounted for on the next dispatch. */
+        s->stats.pending_usec = 0;
+}
+
 static int source_dispatch(sd_event_source *s) {
+        usec_t begin = USEC_INFINITY, begin_cpu = USEC_INFINITY;
         EventSourceType saved_type;
         sd_event *saved_event;
         int r = 0;
@@ -4179,6 +4361,13 @@ static int source_dispatch(sd_event_source *s) {
                         return r;
         }
 
+        if (saved_event->profile_delays) {
+                begin = now(CLOCK_MONOTONIC);
+                begin_cpu = now(CLOCK_THREAD_CPUTIME_ID);
+
+                source_account_latency(s, begin);
+        }
+
         s->dispatching = true;
 
         switch (s->type) {
@@ -4271,6 +4460,9 @@ static int source_dispatch(sd_event_source *s) {
 
         s->dispatching = false;
 
+        if (begin != USEC_INFINITY)
+                source_account_dispatch(s, begin, begin_cpu);
+
 finish:
         if (r < 0) {
                 log_debug_errno(r, "Event source %s (type %s) returned error, %s: %m",
@@ -4500,9 +4692,38 @@ _public_ int sd_event_prepare(sd_event *e) {
 
         event_close_inode_data_fds(e);
 
-        if (event_next_pending(e) || e->need_process_child || e->buffered_inotify_data_list)
+        if (e->need_process_child || e->buffered_inotify_data_list)
                 goto pending;
 
+        if (event_next_pending(e)) {
+                /* By default we check for new events before dispatching every single event source, so that
+                 * events of higher priority are always dispatched first. If a dispatch budget is set, skip
+                 * that for the already pending sources until the budget is used up. We still update the
+                 * timestamps and process elapsed timers and the watchdog, since that doesn't need any
+                 * syscall beyond clock_gettime(), so that neither sd_event_now() nor timers lag behind. */
+                if (e->n_dispatched_without_wait + 1 < e->dispatch_budget) {
+                        triple_timestamp_now(&e->timestamp);
+
+                        r = process_watchdog(e);
+                        if (r < 0)
+                                return r;
+
+                        r = process_timers(e);
+                        if (r < 0)
+                                return r;
+                        if (r == 0) {
+                                e->n_dispatched_without_wait++;
+                                e->state = SD_EVENT_PENDING;
+                                return 1;
+                        }
+
+                        /* A ratelimit expiry callback was invoked, and might have re-enabled sources of
+                         * higher priority. Do a full check for new events. */
+                }
+
+                goto pending;
+        }
+
         e->state = SD_EVENT_ARMED;
 
         return 0;
@@ -4699,6 +4920,8 @@ _public_ int sd_event_wait(sd_event *e, uint64_t timeout) {
                 return 1;
         }
 
+        e->n_dispatched_without_wait = 0;
+
         for (int64_t threshold = INT64_MAX; ; threshold--) {
                 int64_t epoll_min_priority, child_min_priority;
 
@@ -4743,23 +4966,7 @@ _public_ int sd_event_wait(sd_event *e, uint64_t timeout) {
         if (r < 0)
                 goto finish;
 
-        r = process_timer(e, e->timestamp.realtime, &e->realtime);
-        if (r < 0)
-                goto finish;
-
-        r = process_timer(e, e->timestamp.boottime, &e->boottime);
-        if (r < 0)
-                goto finish;
-
-        r = process_timer(e, e->timestamp.realtime, &e->realtime_alarm);
-        if (r < 0)
-                goto finish;
-
-        r = process_timer(e, e->timestamp.boottime, &e->boottime_alarm);
-        if (r < 0)
-                goto finish;
-
-        r = process_timer(e, e->timestamp.monotonic, &e->monotonic);
+        r = process_timers(e);
         if (r < 0)
                 goto finish;
         else if (r == 1) {
@@ -4767,9 +4974,9 @@ _public_ int sd_event_wait(sd_event *e, uint64_t timeout) {
                  * put loop in the initial state in order to evaluate (in the next iteration) also sources
                  * there were potentially re-enabled by the callback.
                  *
-                 * Wondering why we treat only this invocation of process_timer() differently? Once event
-                 * source is ratelimited we essentially transform it into CLOCK_MONOTONIC timer hence
-                 * ratelimit expiry callback is never called for any other timer type. */
+                 * Wondering why we only check this for CLOCK_MONOTONIC timers? Once event source is
+                 * ratelimited we essentially transform it into CLOCK_MONOTONIC timer hence ratelimit
+                 * expiry callback is never called for any other timer type. */
                 r = 0;
                 goto finish;
         }
@@ -4826,6 +5033,20 @@ static void event_log_delays(sd_event *e) {
                 e->delays[i] = 0;
         }
         log_debug("Event loop iterations: %s", b);
+
+        LIST_FOREACH(sources, s, e->sources) {
+                if (s->stats.n_dispatched == 0)
+                        continue;
+
+                log_debug("Event source %s (type %s): %" PRIu64 " dispatches, %s total, %s max, %s CPU, %s max latency",
+                          strna(s->description),
+                          event_source_type_to_string(s->type),
+                          s->stats.n_dispatched,
+                          FORMAT_TIMESPAN(s->stats.dispatch_usec, 1),
+                          FORMAT_TIMESPAN(s->stats.dispatch_max_usec, 1),
+                          FORMAT_TIMESPAN(s->stats.cpu_usec, 1),
+                          FORMAT_TIMESPAN(s->stats.latency_max_usec, 1));
+        }
 }
 
 _public_ int sd_event_run(sd_event *e, uint64_t timeout) {
@@ -5026,6 +5247,8 @@ _public_ int sd_event_set_watchdog(sd_event *e, int b) {
                         .data.ptr = INT_TO_PTR(SOURCE_WATCHDOG),
                 };
 
+                event_flush_io_unregister_list(e);
+
                 if (epoll_ctl(e->epoll_fd, EPOLL_CTL_ADD, e->watchdog_fd, &ev) < 0) {
                         r = -errno;
                         goto fail;
@@ -5063,6 +5286,54 @@ _public_ int sd_event_get_iteration(sd_event *e, uint64_t *ret) {
         return 0;
 }
 
+int event_source_get_statistics(
+                sd_event_source *s,
+                uint64_t *ret_n_dispatched,
+                uint64_t *ret_dispatch_usec,
+                uint64_t *ret_dispatch_max_usec,
+                uint64_t *ret_cpu_usec,
+                uint64_t *ret_latency_max_usec) {
+
+        assert(s);
+        assert(!event_origin_changed(s->event));
+
+        if (!s->event->profile_delays)
+                return -ENODATA;
+
+        if (ret_n_dispatched)
+                *ret_n_dispatched = s->stats.n_dispatched;
+        if (ret_dispatch_usec)
+                *ret_dispatch_usec = s->stats.dispatch_usec;
+        if (ret_dispatch_max_usec)
+                *ret_dispatch_max_usec = s->stats.dispatch_max_usec;
+        if (ret_cpu_usec)
+                *ret_cpu_usec = s->stats.cpu_usec;
+        if (ret_latency_max_usec)
+                *ret_latency_max_usec = s->stats.latency_max_usec;
+        return 0;
+}
+
+int event_set_dispatch_budget(sd_event *e, unsigned budget) {
+        assert_return(e, -EINVAL);
+        assert_return(e = event_resolve(e), -ENOPKG);
+        assert_return(e->state != SD_EVENT_FINISHED, -ESTALE);
+        assert_return(!event_origin_changed(e), -ECHILD);
+
+        e->dispatch_budget = MAX(budget, 1u);
+        return 0;
+}
+
+int event_get_dispatch_budget(sd_event *e, unsigned *ret) {
+        assert_return(e, -EINVAL);
+        assert_return(e = event_resolve(e), -ENOPKG);
+        assert_return(ret, -EINVAL);
+        assert_return(e->state != SD_EVENT_FINISHED, -ESTALE);
+        assert_return(!event_origin_changed(e), -ECHILD);
+
+        *ret = MAX(e->dispatch_budget, 1u);
+        return 0;
+}
+
 _public_ int sd_event_source_set_destroy_callback(sd_event_source *s, sd_event_destroy_t callback) {
         assert_return(s, -EINVAL);
         assert_return(s->event, -EINVAL);
@@ -6,6 +6,7 @@
 #include "sd-event.h"
 
 #include "alloc-util.h"
+#include "event-util.h"
 #include "exec-util.h"
 #include "fd-util.h"
 #include "fs-util.h"
@@ -723,6 +724,59 @@ TEST(simple_timeout) {
         assert_se(t >= usec_add(f, some_time));
 }
 
+static int time_disabled_handler(sd_event_source *s, uint64_t usec, void *userdata) {
+        unsigned *last = ASSERT_PTR(userdata);
+        const char *description;
+
+        assert_se(sd_event_source_get_description(s, &description) >= 0);
+        assert_se(safe_atou(description, last) >= 0);
+
+        log_info("time source %s dispatched", description);
+        return 0;
+}
+
+TEST(time_disabled) {
+        _cleanup_(sd_event_unrefp) sd_event *e = NULL;
+        sd_event_source *s[5];
+        unsigned last = UINT_MAX;
+        usec_t n;
+
+        assert_se(sd_event_default(&e) >= 0);
+        assert_se(sd_event_now(e, CLOCK_MONOTONIC, &n) >= 0);
+
+        for (unsigned i = 0; i < ELEMENTSOF(s); i++) {
+                char d[DECIMAL_STR_MAX(unsigned)];
+
+                assert_se(sd_event_add_time(e, &s[i], CLOCK_MONOTONIC, USEC_INFINITY, 0, time_disabled_handler, &last) >= 0);
+                xsprintf(d, "%u", i);
+                assert_se(sd_event_source_set_description(s[i], d) >= 0);
+                assert_se(sd_event_source_set_enabled(s[i], SD_EVENT_OFF) >= 0);
+        }
+
+        /* The time of disabled sources doesn't affect their position in the prioqs, make sure they are
+         * ordered properly once enabled again. */
+        for (unsigned i = ELEMENTSOF(s); i > 0; i--)
+                assert_se(sd_event_source_set_time(s[i-1], i == 1 ? n : n + i * USEC_PER_HOUR) >= 0);
+        for (unsigned i = 0; i < ELEMENTSOF(s); i++)
+                assert_se(sd_event_source_set_enabled(s[i], SD_EVENT_ONESHOT) >= 0);
+
+        assert_se(sd_event_run(e, 0) > 0);
+        assert_se(last == 0);
+        assert_se(sd_event_run(e, 0) == 0);
+
+        assert_se(sd_event_source_set_enabled(s[3], SD_EVENT_OFF) >= 0);
+        assert_se(sd_event_source_set_time(s[3], n) >= 0);
+        assert_se(sd_event_source_set_time_accuracy(s[3], 1) >= 0);
+        assert_se(sd_event_source_set_enabled(s[3], SD_EVENT_ONESHOT) >= 0);
+
+        assert_se(sd_event_run(e, 0) > 0);
+        assert_se(last == 3);
+        assert_se(sd_event_run(e, 0) == 0);
+
+        FOREACH_ARRAY(i, s, ELEMENTSOF(s))
+                sd_event_source_unref(*i);
+}
+
 static int inotify_self_destroy_handler(sd_event_source *s, const struct inotify_event *ev, void *userdata) {
         sd_event_source **p = userdata;
 
@@ -846,6 +900,321 @@ TEST(sd_event_source_set_io_fd) {
         TAKE_FD(pfd_b[0]);
 }
 
+static int io_count_handler(sd_event_source *s, int fd, uint32_t revents, void *userdata) {
+        unsigned *c = ASSERT_PTR(userdata);
+        char x;
+
+        assert_se(read(fd, &x, 1) == 1);
+
+        (*c)++;
+        return 0;
+}
+
+TEST(io_disable_reenable) {
+        _cleanup_(sd_event_source_unrefp) sd_event_source *a = NULL, *b = NULL;
+        _cleanup_(sd_event_unrefp) sd_event *e = NULL;
+        _cleanup_close_pair_ int pfd_a[2] = EBADF_PAIR, pfd_b[2] = EBADF_PAIR;
+        _cleanup_close_ int saved_fd = -EBADF;
+        unsigned count_a = 0, count_b = 0;
+        int fd;
+
+        assert_se(sd_event_default(&e) >= 0);
+
+        assert_se(pipe2(pfd_a, O_CLOEXEC|O_NONBLOCK) >= 0);
+        assert_se(pipe2(pfd_b, O_CLOEXEC|O_NONBLOCK) >= 0);
+
+        assert_se(sd_event_add_io(e, &a, pfd_a[0], EPOLLIN, io_count_handler, &count_a) >= 0);
+
+        /* Disabling and re-enabling a source between two iterations must not lose events */
+        assert_se(write(pfd_a[1], "x", 1) == 1);
+        assert_se(sd_event_source_set_enabled(a, SD_EVENT_OFF) >= 0);
+        assert_se(sd_event_source_set_enabled(a, SD_EVENT_ONESHOT) >= 0);
+        assert_se(sd_event_run(e, 0) > 0);
+        assert_se(count_a == 1);
+
+        /* Re-enabling a dispatched ONESHOT source reuses its disarmed epoll registration */
+        assert_se(write(pfd_a[1], "x", 1) == 1);
+        assert_se(sd_event_source_set_enabled(a, SD_EVENT_ONESHOT) >= 0);
+        assert_se(sd_event_run(e, 0) > 0);
+        assert_se(count_a == 2);
+
+        /* A disabled source must not be dispatched */
+        assert_se(write(pfd_a[1], "x", 1) == 1);
+        assert_se(sd_event_source_set_enabled(a, SD_EVENT_ON) >= 0);
+        assert_se(sd_event_source_set_enabled(a, SD_EVENT_OFF) >= 0);
+        assert_se(sd_event_run(e, 0) == 0);
+        assert_se(count_a == 2);
+
+        /* Replace the fd of a dispatched ONESHOT source by another file, while the old file is kept open
+         * elsewhere, and watch the new file with another source. Neither adding the new source nor
+         * freeing the old one may remove the registration of the new file. */
+        assert_se(sd_event_source_set_enabled(a, SD_EVENT_ONESHOT) >= 0);
+        assert_se(sd_event_run(e, 0) > 0);
+        assert_se(count_a == 3);
+        assert_se(sd_event_source_get_enabled(a, NULL) == 0);
+
+        saved_fd = fcntl(pfd_a[0], F_DUPFD_CLOEXEC, 3);
+        assert_se(saved_fd >= 0);
+        fd = pfd_a[0];
+        assert_se(dup3(pfd_b[0], fd, O_CLOEXEC) == fd);
+
+        assert_se(sd_event_add_io(e, &b, fd, EPOLLIN, io_count_handler, &count_b) >= 0);
+        a = sd_event_source_unref(a);
+
+        assert_se(write(pfd_b[1], "x", 1) == 1);
+        assert_se(sd_event_run(e, 0) > 0);
+        assert_se(count_b == 1);
+}
+
+struct budget_test {
+        int fds[3][2];
+        char order[4];
+        size_t n;
+};
+
+static int budget_handler(sd_event_source *s, int fd, uint32_t revents, void *userdata) {
+        struct budget_test *t = ASSERT_PTR(userdata);
+        const char *description;
+        char x;
+
+        assert_se(read(fd, &x, 1) == 1);
+        assert_se(sd_event_source_get_description(s, &description) >= 0);
+        assert_se(t->n < ELEMENTSOF(t->order) - 1);
+        t->order[t->n++] = description[0];
+
+        /* Make the source with the highest priority pending while another one is already pending */
+        if (description[0] == 'a')
+                assert_se(write(t->fds[2][1], "x", 1) == 1);
+
+        return 0;
+}
+
+static void test_dispatch_budget_one(unsigned budget, const char *expected) {
+        _cleanup_(sd_event_source_unrefp) sd_event_source *a = NULL, *b = NULL, *c = NULL;
+        _cleanup_(sd_event_unrefp) sd_event *e = NULL;
+        struct budget_test t = {};
+        unsigned v;
+
+        log_info("/* %s(%u) */", __func__, budget);
+
+        assert_se(sd_event_new(&e) >= 0);
+        assert_se(event_set_dispatch_budget(e, budget) >= 0);
+        assert_se(event_get_dispatch_budget(e, &v) >= 0);
+        assert_se(v == MAX(budget, 1u));
+
+        FOREACH_ARRAY(p, t.fds, ELEMENTSOF(t.fds))
+                assert_se(pipe2(*p, O_CLOEXEC|O_NONBLOCK) >= 0);
+
+        assert_se(sd_event_add_io(e, &a, t.fds[0][0], EPOLLIN, budget_handler, &t) >= 0);
+        assert_se(sd_event_source_set_description(a, "a") >= 0);
+        assert_se(sd_event_add_io(e, &b, t.fds[1][0], EPOLLIN, budget_handler, &t) >= 0);
+        assert_se(sd_event_source_set_description(b, "b") >= 0);
+        assert_se(sd_event_source_set_priority(b, 1) >= 0);
+        assert_se(sd_event_add_io(e, &c, t.fds[2][0], EPOLLIN, budget_handler, &t) >= 0);
+        assert_se(sd_event_source_set_description(c, "c") >= 0);
+        assert_se(sd_event_source_set_priority(c, -1) >= 0);
+
+        assert_se(write(t.fds[0][1], "x", 1) == 1);
+        assert_se(write(t.fds[1][1], "x", 1) == 1);
+
+        for (unsigned i = 0; i < 3; i++)
+                assert_se(sd_event_run(e, 0) > 0);
+        assert_se(sd_event_run(e, 0) == 0);
+
+        assert_se(streq(t.order, expected));
+
+        FOREACH_ARRAY(p, t.fds, ELEMENTSOF(t.fds))
+                safe_close_pair(*p);
+}
+
+TEST(dispatch_budget) {
+        /* By default the loop checks for new events before each dispatch, hence 'c' preempts 'b'. With a
+         * budget, the already pending 'b' is dispatched first. */
+        test_dispatch_budget_one(0, "acb");
+        test_dispatch_budget_one(1, "acb");
+        test_dispatch_budget_one(2, "abc");
+        test_dispatch_budget_one(16, "abc");
+}
+
+struct budget_time_test {
+        sd_event_source *timer;
+        usec_t deadline;
+        char order[4];
+        size_t n;
+};
+
+static int budget_time_handler(sd_event_source *s, uint64_t usec, void *userdata) {
+        struct budget_time_test *t = ASSERT_PTR(userdata);
+        usec_t n;
+
+        /* The timestamp must have been refreshed even though we didn't go through sd_event_wait() */
+        assert_se(sd_event_now(sd_event_source_get_event(s), CLOCK_MONOTONIC, &n) >= 0);
+        assert_se(n >= t->deadline);
+
+        assert_se(t->n < ELEMENTSOF(t->order) - 1);
+        t->order[t->n++] = 't';
+        return 0;
+}
+
+static int budget_time_io_handler(sd_event_source *s, int fd, uint32_t revents, void *userdata) {
+        struct budget_time_test *t = ASSERT_PTR(userdata);
+        const char *description;
+        char x;
+
+        assert_se(read(fd, &x, 1) == 1);
+        assert_se(sd_event_source_get_description(s, &description) >= 0);
+        assert_se(t->n < ELEMENTSOF(t->order) - 1);
+        t->order[t->n++] = description[0];
+
+        /* Add a timer with the highest priority that has already elapsed when the next iteration starts */
+        if (description[0] == 'a') {
+                t->deadline = now(CLOCK_MONOTONIC);
+                assert_se(sd_event_add_time(sd_event_source_get_event(s), &t->timer, CLOCK_MONOTONIC,
+                                            t->deadline, 0, budget_time_handler, t) >= 0);
+                assert_se(sd_event_source_set_priority(t->timer, -1) >= 0);
+        }
+
+        return 0;
+}
+
+TEST(dispatch_budget_time) {
+        _cleanup_(sd_event_source_unrefp) sd_event_source *a = NULL, *b = NULL;
+        _cleanup_(sd_event_unrefp) sd_event *e = NULL;
+        int fds[2][2];
+        struct budget_time_test t = {};
+
+        /* Elapsed timers are still processed while the dispatch budget is not used up, hence the timer
+         * preempts the already pending 'b'. */
+
+        assert_se(sd_event_new(&e) >= 0);
+        assert_se(event_set_dispatch_budget(e, 16) >= 0);
+
+        FOREACH_ARRAY(p, fds, ELEMENTSOF(fds))
+                assert_se(pipe2(*p, O_CLOEXEC|O_NONBLOCK) >= 0);
+
+        assert_se(sd_event_add_io(e, &a, fds[0][0], EPOLLIN, budget_time_io_handler, &t) >= 0);
+        assert_se(sd_event_source_set_description(a, "a") >= 0);
+        assert_se(sd_event_add_io(e, &b, fds[1][0], EPOLLIN, budget_time_io_handler, &t) >= 0);
+        assert_se(sd_event_source_set_description(b, "b") >= 0);
+        assert_se(sd_event_source_set_priority(b, 1) >= 0);
+
+        assert_se(write(fds[0][1], "x", 1) == 1);
+        assert_se(write(fds[1][1], "x", 1) == 1);
+
+        for (unsigned i = 0; i < 3; i++)
+                assert_se(sd_event_run(e, 0) > 0);
+
+        assert_se(streq(t.order, "atb"));
+
+        t.timer = sd_event_source_unref(t.timer);
+        FOREACH_ARRAY(p, fds, ELEMENTSOF(fds))
+                safe_close_pair(*p);
+}
+
+static int statistics_handler(sd_event_source *s, int fd, uint32_t revents, void *userdata) {
+        char x;
+
+        assert_se(read(fd, &x, 1) == 1);
+        return 0;
+}
+
+TEST(statistics) {
+        _cleanup_(sd_event_source_unrefp) sd_event_source *s = NULL;
+        _cleanup_(sd_event_unrefp) sd_event *e = NULL;
+        _cleanup_close_pair_ int p[2] = EBADF_PAIR;
+        uint64_t n, total, max, cpu, latency;
+
+        assert_se(pipe2(p, O_CLOEXEC|O_NONBLOCK) >= 0);
+
+        assert_se(sd_event_new(&e) >= 0);
+        assert_se(sd_event_add_io(e, &s, p[0], EPOLLIN, statistics_handler, NULL) >= 0);
+        assert_se(event_source_get_statistics(s, &n, NULL, NULL, NULL, NULL) == -ENODATA);
+
+        s = sd_event_source_unref(s);
+        e = sd_event_unref(e);
+
+        assert_se(setenv("SD_EVENT_PROFILE_DELAYS", "1", /* overwrite = */ true) >= 0);
+        assert_se(sd_event_new(&e) >= 0);
+        assert_se(unsetenv("SD_EVENT_PROFILE_DELAYS") >= 0);
+
+        assert_se(sd_event_add_io(e, &s, p[0], EPOLLIN, statistics_handler, NULL) >= 0);
+        assert_se(event_source_get_statistics(s, &n, &total, &max, &cpu, &latency) >= 0);
+        assert_se(n == 0);
+        assert_se(total == 0);
+
+        for (unsigned i = 0; i < 3; i++) {
+                assert_se(write(p[1], "x", 1) == 1);
+                assert_se(sd_event_run(e, 0) > 0);
+        }
+
+        assert_se(event_source_get_statistics(s, &n, &total, &max, &cpu, &latency) >= 0);
+        log_info("dispatched %" PRIu64 " times, %s total, %s max, %s CPU, %s max latency",
+                 n, FORMAT_TIMESPAN(total, 1), FORMAT_TIMESPAN(max, 1), FORMAT_TIMESPAN(cpu, 1), FORMAT_TIMESPAN(latency, 1));
+        assert_se(n == 3);
+        assert_se(max <= total);
+}
+
+struct reopen_data {
+        int replacement_fd;
+        bool set_io_fd;
+        unsigned count;
+};
+
+static int io_reopen_handler(sd_event_source *s, int fd, uint32_t revents, void *userdata) {
+        struct reopen_data *d = ASSERT_PTR(userdata);
+
+        d->count++;
+
+        /* Close the fd and get the same fd number back for a different file, then re-enable the source */
+        assert_se(close_nointr(fd) >= 0);
+        assert_se(dup3(d->replacement_fd, fd, O_CLOEXEC) == fd);
+
+        if (d->set_io_fd)
+                assert_se(sd_event_source_set_io_fd(s, fd) >= 0);
+
+        assert_se(sd_event_source_set_enabled(s, SD_EVENT_ONESHOT) >= 0);
+        return 0;
+}
+
+static void test_io_reopen_in_oneshot_one(bool set_io_fd) {
+        _cleanup_(sd_event_source_unrefp) sd_event_source *s = NULL;
+        _cleanup_(sd_event_unrefp) sd_event *e = NULL;
+        _cleanup_close_pair_ int pfd_a[2] = EBADF_PAIR, pfd_b[2] = EBADF_PAIR;
+        struct reopen_data d = {
+                .set_io_fd = set_io_fd,
+        };
+        char x;
+
+        log_info("/* %s(set_io_fd=%s) */", __func__, yes_no(set_io_fd));
+
+        assert_se(sd_event_new(&e) >= 0);
+
+        assert_se(pipe2(pfd_a, O_CLOEXEC|O_NONBLOCK) >= 0);
+        assert_se(pipe2(pfd_b, O_CLOEXEC|O_NONBLOCK) >= 0);
+        d.replacement_fd = pfd_b[0];
+
+        assert_se(sd_event_add_io(e, &s, pfd_a[0], EPOLLIN, io_reopen_handler, &d) >= 0);
+        assert_se(sd_event_source_set_enabled(s, SD_EVENT_ONESHOT) >= 0);
+
+        assert_se(write(pfd_a[1], "x", 1) == 1);
+        assert_se(sd_event_run(e, 0) > 0);
+        assert_se(d.count == 1);
+
+        /* The source now watches the replacement file under the old fd number */
+        assert_se(sd_event_source_get_enabled(s, NULL) > 0);
+        assert_se(sd_event_run(e, 0) == 0);
+
+        assert_se(write(pfd_b[1], "x", 1) == 1);
+        assert_se(sd_event_run(e, 0) > 0);
+        assert_se(d.count == 2);
+        assert_se(read(pfd_a[0], &x, 1) == 1);
+}
+
+TEST(io_reopen_in_oneshot) {
+        test_io_reopen_in_oneshot_one(false);
+        test_io_reopen_in_oneshot_one(true);
+}
+
 static int hup_callback(sd_event_source *s, int fd, uint32_t revents, void *userdata) {
         unsigned *c = userdata;
 
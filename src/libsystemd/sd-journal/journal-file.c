@@ -293,6 +293,7 @@ JournalFile* journal_file_close(JournalFile *f) {
         free(f->path);
 
         ordered_hashmap_free_free(f->chain_cache);
+        hashmap_free_free(f->match_cache);
 
 #if HAVE_COMPRESSION
         free(f->compress_buffer);
@@ -2526,6 +2527,14 @@ int journal_file_append_entry(
         assert(iovec);
         assert(n_iovec > 0);
 
+        /* Entries are appended one at a time, there's deliberately no batch variant of this call. journald
+         * writes every message as soon as it is received, so that readers see it right away and nothing is
+         * lost if we crash, hence there is no batch to pass in. Collecting one would delay when entries
+         * become visible, and complicate rotation and error handling, since a failure half way through
+         * would leave only part of the batch written. The costly parts of appending are amortized already:
+         * DATA objects are deduplicated via the hash table, and readers are notified via the deferred
+         * post-change timer, not once per entry. */
+
         if (ts) {
                 if (!VALID_REALTIME(ts->realtime))
                         return log_debug_errno(SYNTHETIC_ERRNO(EBADMSG),
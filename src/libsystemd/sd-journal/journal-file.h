@@ -95,6 +95,7 @@ typedef struct JournalFile {
         usec_t post_change_timer_period;
 
         OrderedHashmap *chain_cache;
+        Hashmap *match_cache; /* sd-journal only: discrete Match → DATA object offset, see next_for_match() */
 
         pthread_t offline_thread;
         volatile OfflineState offline_state;
@@ -130,6 +131,7 @@ typedef struct JournalFile {
         uint64_t newest_realtime_usec;
         unsigned newest_boot_id_prioq_idx;
         usec_t newest_mtime;
+        bool newest_final; /* the file was archived when we read the above, hence they won't change anymore */
 } JournalFile;
 
 typedef enum JournalFileFlags {
@@ -7,6 +7,7 @@
 #include "alloc-util.h"
 #include "errno-util.h"
 #include "fd-util.h"
+#include "format-util.h"
 #include "hashmap.h"
 #include "list.h"
 #include "log.h"
@@ -42,6 +43,18 @@ struct Window {
         LIST_FIELDS(Window, unused);
 };
 
+typedef enum WindowAccess {
+        WINDOW_ACCESS_RANDOM,
+        WINDOW_ACCESS_FORWARD,
+        WINDOW_ACCESS_BACKWARD,
+} WindowAccess;
+
+typedef struct AccessPattern {
+        uint64_t offset;    /* The last window we mapped for this category */
+        size_t size;
+        size_t window_size; /* The size of the next window, grows while the access is sequential */
+} AccessPattern;
+
 struct MMapFileDescriptor {
         MMapCache *cache;
 
@@ -50,6 +63,8 @@ struct MMapFileDescriptor {
         bool sigbus;
 
         LIST_HEAD(Window, windows);
+
+        AccessPattern patterns[_MMAP_CACHE_CATEGORY_MAX];
 };
 
 struct MMapCache {
@@ -59,6 +74,9 @@ struct MMapCache {
         unsigned n_category_cache_hit;
         unsigned n_window_list_hit;
         unsigned n_missed;
+        unsigned n_sequential;
+
+        uint64_t window_bytes;
 
         Hashmap *fds;
 
@@ -73,8 +91,12 @@ struct MMapCache {
 #if ENABLE_DEBUG_MMAP_CACHE
 /* Tiny windows increase mmap activity and the chance of exposing unsafe use. */
 # define WINDOW_SIZE (page_size())
+# define WINDOW_SIZE_MAX WINDOW_SIZE
 #else
 # define WINDOW_SIZE ((size_t) (UINT64_C(8) * UINT64_C(1024) * UINT64_C(1024)))
+/* Windows for sequential access may grow up to this size, but let's not exhaust the address space on
+ * 32-bit archs. */
+# define WINDOW_SIZE_MAX (sizeof(void*) >= 8 ? 8 * WINDOW_SIZE : WINDOW_SIZE)
 #endif
 
 MMapCache* mmap_cache_new(void) {
@@ -96,8 +118,10 @@ static Window* window_unlink(Window *w) {
 
         MMapCache *m = mmap_cache_fd_cache(w->fd);
 
-        if (w->ptr)
+        if (w->ptr) {
                 munmap(w->ptr, w->size);
+                m->window_bytes -= w->size;
+        }
 
         if (FLAGS_SET(w->flags, WINDOW_IN_UNUSED)) {
                 if (m->last_unused == w)
@@ -177,6 +201,8 @@ static Window* window_add(MMapFileDescriptor *f, uint64_t offset, size_t size, v
                 .ptr = ptr,
         };
 
+        m->window_bytes += size;
+
         return LIST_PREPEND(windows, f->windows, w);
 }
 
@@ -272,18 +298,49 @@ static int mmap_try_harder(MMapFileDescriptor *f, void *addr, int flags, uint64_
         }
 }
 
+static WindowAccess access_pattern_update(AccessPattern *a, uint64_t offset) {
+        WindowAccess access;
+
+        assert(a);
+
+        /* Called on each miss. If the requested offset is right behind (or before) the window we mapped
+         * last for the same category, the caller is likely scanning through the file, hence let's map
+         * larger windows in the direction of the scan. Any other miss is considered random access (e.g.
+         * bisection), for which we go back to the default window size. */
+
+        if (a->size == 0)
+                access = WINDOW_ACCESS_RANDOM;
+        else if (offset >= a->offset && offset - a->offset <= 2 * (uint64_t) a->size)
+                access = WINDOW_ACCESS_FORWARD;
+        else if (offset < a->offset && a->offset - offset <= a->size)
+                access = WINDOW_ACCESS_BACKWARD;
+        else
+                access = WINDOW_ACCESS_RANDOM;
+
+        if (access == WINDOW_ACCESS_RANDOM || a->window_size == 0)
+                a->window_size = WINDOW_SIZE;
+        else
+                a->window_size = MIN(a->window_size * 2, WINDOW_SIZE_MAX);
+
+        return access;
+}
+
 static int add_mmap(
                 MMapFileDescriptor *f,
+                AccessPattern *a,
                 uint64_t offset,
                 size_t size,
                 struct stat *st,
                 Window **ret) {
 
+        MMapCache *m = mmap_cache_fd_cache(f);
+        WindowAccess access;
         Window *w;
         void *d;
         int r;
 
         assert(f);
+        assert(a);
         assert(size > 0);
         assert(ret);
 
@@ -291,15 +348,31 @@ static int add_mmap(
         if (size > SIZE_MAX - PAGE_OFFSET_U64(offset))
                 return -EADDRNOTAVAIL;
 
+        access = access_pattern_update(a, offset);
+
         size = PAGE_ALIGN(size + PAGE_OFFSET_U64(offset));
         offset = PAGE_ALIGN_DOWN_U64(offset);
 
-        if (size < WINDOW_SIZE) {
+        if (size < a->window_size) {
                 uint64_t delta;
 
-                delta = PAGE_ALIGN((WINDOW_SIZE - size) / 2);
-                offset = LESS_BY(offset, delta);
-                size = WINDOW_SIZE;
+                switch (access) {
+
+                case WINDOW_ACCESS_FORWARD:
+                        /* Map everything from the requested offset onwards */
+                        break;
+
+                case WINDOW_ACCESS_BACKWARD:
+                        /* Map everything up to the end of the requested range */
+                        offset = LESS_BY(offset, (uint64_t) (a->window_size - size));
+                        break;
+
+                default:
+                        delta = PAGE_ALIGN((a->window_size - size) / 2);
+                        offset = LESS_BY(offset, delta);
+                }
+
+                size = a->window_size;
         }
 
         if (st) {
@@ -320,12 +393,25 @@ static int add_mmap(
         if (r < 0)
                 return r;
 
+        if (access != WINDOW_ACCESS_RANDOM) {
+                /* We'll likely access the whole window soon, hence ask the kernel to start reading it in
+                 * right away, instead of faulting the pages in one by one. Note that we don't use
+                 * MAP_POPULATE for this, since that would block until everything is read. */
+                if (madvise(d, size, MADV_WILLNEED) < 0)
+                        log_debug_errno(errno, "Failed to issue MADV_WILLNEED on memory map, ignoring: %m");
+
+                m->n_sequential++;
+        }
+
         w = window_add(f, offset, size, d);
         if (!w) {
                 (void) munmap(d, size);
                 return -ENOMEM;
         }
 
+        a->offset = offset;
+        a->size = size;
+
         *ret = w;
         return 0;
 }
@@ -371,7 +457,7 @@ int mmap_cache_fd_get(
         m->n_missed++;
 
         /* Create a new mmap */
-        r = add_mmap(f, offset, size, st, &w);
+        r = add_mmap(f, f->patterns + c, offset, size, st, &w);
         if (r < 0)
                 return r;
 
@@ -427,11 +513,27 @@ found:
         return 1;
 }
 
+void mmap_cache_get_stats(MMapCache *m, MMapCacheStats *ret) {
+        assert(m);
+        assert(ret);
+
+        *ret = (MMapCacheStats) {
+                .n_windows = m->n_windows,
+                .window_bytes = m->window_bytes,
+                .n_category_cache_hit = m->n_category_cache_hit,
+                .n_window_list_hit = m->n_window_list_hit,
+                .n_missed = m->n_missed,
+                .n_sequential = m->n_sequential,
+        };
+}
+
 void mmap_cache_stats_log_debug(MMapCache *m) {
         assert(m);
 
-        log_debug("mmap cache statistics: %u category cache hit, %u window list hit, %u miss",
-                  m->n_category_cache_hit, m->n_window_list_hit, m->n_missed);
+        log_debug("mmap cache statistics: %u category cache hit, %u window list hit, %u miss (%u sequential), "
+                  "%u windows (%s mapped)",
+                  m->n_category_cache_hit, m->n_window_list_hit, m->n_missed, m->n_sequential,
+                  m->n_windows, FORMAT_BYTES(m->window_bytes));
 }
 
 static void mmap_cache_process_sigbus(MMapCache *m) {
@@ -55,6 +55,16 @@ int mmap_cache_add_fd(MMapCache *m, int fd, int prot, MMapFileDescriptor **ret);
 MMapCache* mmap_cache_fd_cache(MMapFileDescriptor *f);
 MMapFileDescriptor* mmap_cache_fd_free(MMapFileDescriptor *f);
 
+typedef struct MMapCacheStats {
+        unsigned n_windows;
+        uint64_t window_bytes;
+        unsigned n_category_cache_hit;
+        unsigned n_window_list_hit;
+        unsigned n_missed;
+        unsigned n_sequential; /* misses for which we mapped a window in the direction of a sequential scan */
+} MMapCacheStats;
+
+void mmap_cache_get_stats(MMapCache *m, MMapCacheStats *ret);
 void mmap_cache_stats_log_debug(MMapCache *m);
 
 bool mmap_cache_fd_got_sigbus(MMapFileDescriptor *f);
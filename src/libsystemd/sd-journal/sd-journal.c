@@ -38,6 +38,7 @@
 #include "prioq.h"
 #include "process-util.h"
 #include "replace-var.h"
+#include "sort-util.h"
 #include "stat-util.h"
 #include "stdio-util.h"
 #include "string-util.h"
@@ -402,12 +403,18 @@ char *journal_make_match_string(sd_journal *j) {
 }
 
 _public_ void sd_journal_flush_matches(sd_journal *j) {
+        JournalFile *f;
+
         if (!j || journal_origin_changed(j))
                 return;
 
         if (j->level0)
                 match_free(j->level0);
 
+        /* The per-file caches are keyed by Match objects, which are all gone now. */
+        ORDERED_HASHMAP_FOREACH(f, j->files)
+                hashmap_clear_free(f->match_cache);
+
         j->level0 = j->level1 = j->level2 = NULL;
 
         detach_location(j);
@@ -474,6 +481,217 @@ static int compare_boot_ids(sd_journal *j, sd_id128_t a, sd_id128_t b) {
         return CMP(x->newest_realtime_usec, y->newest_realtime_usec);
 }
 
+typedef struct BootEntryLocation {
+        uint64_t seqnum;
+        usec_t realtime;
+} BootEntryLocation;
+
+typedef struct BootIndexItem {
+        sd_id128_t id;
+        BootEntryLocation first, last;
+} BootIndexItem;
+
+DEFINE_PRIVATE_HASH_OPS_WITH_VALUE_DESTRUCTOR(boot_index_item_hash_ops,
+                                              sd_id128_t, id128_hash_func, id128_compare_func,
+                                              BootIndexItem, free);
+
+static int boot_entry_location_compare(const BootEntryLocation *a, const BootEntryLocation *b) {
+        /* All locations come from files with the same seqnum ID (see journal_get_boots_from_index()),
+         * hence this orders them like compare_locations() would. The wallclock time is deliberately not
+         * used, as it is unreliable on systems with a missing or wrong RTC. */
+        return CMP(a->seqnum, b->seqnum);
+}
+
+static int boot_index_item_compare(BootIndexItem * const *a, BootIndexItem * const *b) {
+        int r;
+
+        r = boot_entry_location_compare(&(*a)->first, &(*b)->first);
+        if (r != 0)
+                return r;
+
+        return id128_compare_func(&(*a)->id, &(*b)->id);
+}
+
+static int boot_entry_location_get(
+                JournalFile *f,
+                Object *d,
+                direction_t direction,
+                BootEntryLocation *ret) {
+
+        Object *o;
+        int r;
+
+        assert(f);
+        assert(d);
+        assert(ret);
+
+        r = journal_file_move_to_entry_for_data(f, d, direction, &o, NULL);
+        if (IN_SET(r, -EADDRNOTAVAIL, -EBADMSG))
+                return 0; /* Corrupted entry arrays, treat like a boot without entries. */
+        if (r <= 0)
+                return r;
+
+        *ret = (BootEntryLocation) {
+                .seqnum = le64toh(o->entry.seqnum),
+                .realtime = le64toh(o->entry.realtime),
+        };
+
+        return 1;
+}
+
+static int journal_file_index_boots(JournalFile *f, Hashmap **boots) {
+        Object *o;
+        uint64_t p;
+        int r;
+
+        assert(f);
+        assert(boots);
+
+        /* All _BOOT_ID= data objects of a file are linked from the field object, and each of them knows
+         * its first and last entry. Hence we can learn about every boot in the file without iterating
+         * through its entries, and without looking at the other files for each boot we find. */
+
+        r = journal_file_find_field_object(f, "_BOOT_ID", STRLEN("_BOOT_ID"), &o, NULL);
+        if (r <= 0)
+                return r;
+
+        p = le64toh(o->field.head_data_offset);
+        while (p != 0) {
+                BootEntryLocation first, last;
+                BootIndexItem *item;
+                sd_id128_t id;
+                uint64_t next;
+                size_t l;
+                void *data;
+
+                r = journal_file_move_to_object(f, OBJECT_DATA, p, &o);
+                if (r < 0)
+                        return r;
+
+                next = le64toh(o->data.next_field_offset);
+
+                r = journal_file_data_payload(f, o, p, "_BOOT_ID", STRLEN("_BOOT_ID"), 0, &data, &l);
+                if (r < 0)
+                        return r;
+                if (r == 0 || l != STRLEN("_BOOT_ID=") + SD_ID128_STRING_MAX - 1)
+                        goto next;
+
+                char s[SD_ID128_STRING_MAX];
+                memcpy(s, (const char*) data + STRLEN("_BOOT_ID="), sizeof(s) - 1);
+                s[sizeof(s) - 1] = 0;
+                if (sd_id128_from_string(s, &id) < 0)
+                        goto next;
+
+                /* Data objects that are not referenced by any (readable) entry are left over from
+                 * interrupted writes or corruption. Skip them, like discover_next_boot() does. */
+                r = boot_entry_location_get(f, o, DIRECTION_DOWN, &first);
+                if (r < 0)
+                        return r;
+                if (r == 0)
+                        goto next;
+
+                r = boot_entry_location_get(f, o, DIRECTION_UP, &last);
+                if (r < 0)
+                        return r;
+                if (r == 0)
+                        goto next;
+
+                item = hashmap_get(*boots, &id);
+                if (item) {
+                        if (boot_entry_location_compare(&first, &item->first) < 0)
+                                item->first = first;
+                        if (boot_entry_location_compare(&last, &item->last) > 0)
+                                item->last = last;
+                } else {
+                        _cleanup_free_ BootIndexItem *n = NULL;
+
+                        n = new(BootIndexItem, 1);
+                        if (!n)
+                                return -ENOMEM;
+
+                        *n = (BootIndexItem) {
+                                .id = id,
+                                .first = first,
+                                .last = last,
+                        };
+
+                        r = hashmap_ensure_put(boots, &boot_index_item_hash_ops, &n->id, n);
+                        if (r < 0)
+                                return r;
+
+                        TAKE_PTR(n);
+                }
+
+        next:
+                p = next;
+        }
+
+        return 0;
+}
+
+int journal_get_boots_from_index(sd_journal *j, BootId **ret_boots, size_t *ret_n_boots) {
+        _cleanup_hashmap_free_ Hashmap *boots = NULL;
+        _cleanup_free_ BootIndexItem **items = NULL;
+        _cleanup_free_ BootId *ids = NULL;
+        sd_id128_t seqnum_id = SD_ID128_NULL;
+        BootIndexItem *item;
+        JournalFile *f;
+        size_t n = 0;
+        int r;
+
+        assert(j);
+        assert(ret_boots);
+        assert(ret_n_boots);
+
+        /* Returns all boots found in the _BOOT_ID= field index of the open journal files, ordered by the
+         * sequence number of their first entry. Sequence numbers are only comparable within the same
+         * seqnum ID, hence this fails with -EXDEV if the files don't all share one, and the caller has to
+         * walk the journal instead, which orders boots through the full compare_locations() logic. */
+
+        ORDERED_HASHMAP_FOREACH(f, j->files) {
+                if (sd_id128_is_null(seqnum_id))
+                        seqnum_id = f->header->seqnum_id;
+                else if (!sd_id128_equal(seqnum_id, f->header->seqnum_id))
+                        return log_debug_errno(SYNTHETIC_ERRNO(EXDEV),
+                                               "%s: Journal files with different seqnum IDs, can't order boots by index.",
+                                               f->path);
+
+                r = journal_file_index_boots(f, &boots);
+                if (r < 0)
+                        return log_debug_errno(r, "%s: Failed to enumerate boot IDs: %m", f->path);
+        }
+
+        if (hashmap_isempty(boots)) {
+                *ret_boots = NULL;
+                *ret_n_boots = 0;
+                return 0;
+        }
+
+        items = new(BootIndexItem*, hashmap_size(boots));
+        if (!items)
+                return -ENOMEM;
+
+        HASHMAP_FOREACH(item, boots)
+                items[n++] = item;
+
+        typesafe_qsort(items, n, boot_index_item_compare);
+
+        ids = new(BootId, n);
+        if (!ids)
+                return -ENOMEM;
+
+        for (size_t i = 0; i < n; i++)
+                ids[i] = (BootId) {
+                        .id = items[i]->id,
+                        .first_usec = items[i]->first.realtime,
+                        .last_usec = items[i]->last.realtime,
+                };
+
+        *ret_boots = TAKE_PTR(ids);
+        *ret_n_boots = n;
+        return 1;
+}
+
 static int compare_with_location(
                 sd_journal *j,
                 const JournalFile *f,
@@ -533,6 +751,69 @@ static int compare_with_location(
         return 0;
 }
 
+static int find_data_object_for_match(
+                Match *m,
+                JournalFile *f,
+                Object **ret_data,
+                uint64_t *ret_offset) {
+
+        _cleanup_free_ uint64_t *item = NULL;
+        uint64_t *cached, hash, p = 0;
+        Object *d = NULL;
+        int r;
+
+        assert(m);
+        assert(m->type == MATCH_DISCRETE);
+        assert(f);
+
+        /* DATA objects never move once written, hence remember per file which object a discrete match
+         * resolved to. This saves us the hash chain walk (which might involve decompressing every object
+         * on the chain) each time we step to the next matching entry. A cached offset of 0 means the file
+         * does not contain the data at all. We only cache that for archived files, since online files
+         * might still gain the object later on. */
+
+        cached = hashmap_get(f->match_cache, m);
+        if (cached) {
+                if (*cached == 0)
+                        return 0;
+
+                r = journal_file_move_to_object(f, OBJECT_DATA, *cached, ret_data);
+                if (r < 0)
+                        return r;
+
+                if (ret_offset)
+                        *ret_offset = *cached;
+                return 1;
+        }
+
+        /* If the keyed hash logic is used, we need to calculate the hash fresh per file. Otherwise
+         * we can use what we pre-calculated. */
+        if (JOURNAL_HEADER_KEYED_HASH(f->header))
+                hash = journal_file_hash_data(f, m->data, m->size);
+        else
+                hash = m->hash;
+
+        r = journal_file_find_data_object_with_hash(f, m->data, m->size, hash, &d, &p);
+        if (r < 0)
+                return r;
+        if (r == 0 && f->header->state != STATE_ARCHIVED)
+                return 0;
+
+        /* Failing to cache is not fatal, we'll just look the object up again next time. */
+        item = newdup(uint64_t, &p, 1);
+        if (item && hashmap_ensure_put(&f->match_cache, &trivial_hash_ops, m, item) >= 0)
+                TAKE_PTR(item);
+
+        if (r == 0)
+                return 0;
+
+        if (ret_data)
+                *ret_data = d;
+        if (ret_offset)
+                *ret_offset = p;
+        return 1;
+}
+
 static int next_for_match(
                 sd_journal *j,
                 Match *m,
@@ -551,16 +832,8 @@ static int next_for_match(
 
         if (m->type == MATCH_DISCRETE) {
                 Object *d;
-                uint64_t hash;
 
-                /* If the keyed hash logic is used, we need to calculate the hash fresh per file. Otherwise
-                 * we can use what we pre-calculated. */
-                if (JOURNAL_HEADER_KEYED_HASH(f->header))
-                        hash = journal_file_hash_data(f, m->data, m->size);
-                else
-                        hash = m->hash;
-
-                r = journal_file_find_data_object_with_hash(f, m->data, m->size, hash, &d, NULL);
+                r = find_data_object_for_match(m, f, &d, NULL);
                 if (r <= 0)
                         return r;
 
@@ -647,14 +920,9 @@ static int find_location_for_match(
 
         if (m->type == MATCH_DISCRETE) {
                 Object *d;
-                uint64_t dp, hash;
-
-                if (JOURNAL_HEADER_KEYED_HASH(f->header))
-                        hash = journal_file_hash_data(f, m->data, m->size);
-                else
-                        hash = m->hash;
+                uint64_t dp;
 
-                r = journal_file_find_data_object_with_hash(f, m->data, m->size, hash, &d, &dp);
+                r = find_data_object_for_match(m, f, &d, &dp);
                 if (r <= 0)
                         return r;
 
@@ -2397,6 +2665,7 @@ static int journal_file_read_tail_timestamp(sd_journal *j, JournalFile *f) {
         sd_id128_t id;
         ObjectType type;
         Object *o;
+        bool archived;
         int r;
 
         assert(j);
@@ -2405,11 +2674,22 @@ static int journal_file_read_tail_timestamp(sd_journal *j, JournalFile *f) {
 
         /* Tries to read the timestamp of the most recently written entry. */
 
+        /* Archived files are never written to again, hence once we read their tail there's no point in
+         * fstat()ing them again. This is called for every file on every iteration step, hence this saves a
+         * syscall per archived file per entry. Note that we check the state before the fstat(), so that the
+         * tail we read afterwards is known to be the final one. */
+        if (f->newest_final)
+                return 0;
+
+        archived = f->header->state == STATE_ARCHIVED;
+
         r = journal_file_fstat(f);
         if (r < 0)
                 return r;
-        if (f->newest_mtime == timespec_load(&f->last_stat.st_mtim))
+        if (f->newest_mtime == timespec_load(&f->last_stat.st_mtim)) {
+                f->newest_final = archived;
                 return 0; /* mtime didn't change since last time, don't bother */
+        }
 
         if (JOURNAL_HEADER_CONTAINS(f->header, tail_entry_offset)) {
                 offset = le64toh(READ_NOW(f->header->tail_entry_offset));
@@ -2472,6 +2752,7 @@ static int journal_file_read_tail_timestamp(sd_journal *j, JournalFile *f) {
         f->newest_realtime_usec = rt;
         f->newest_machine_id = f->header->machine_id;
         f->newest_mtime = timespec_load(&f->last_stat.st_mtim);
+        f->newest_final = archived;
 
         r = journal_file_reshuffle_newest_by_boot_id(j, f);
         if (r < 0)
@@ -10,6 +10,7 @@
 #include "chattr-util.h"
 #include "iovec-util.h"
 #include "journal-file-util.h"
+#include "journal-internal.h"
 #include "journal-vacuum.h"
 #include "log.h"
 #include "logs-show.h"
@@ -416,6 +417,10 @@ static void test_boot_id_one(void (*setup)(void), size_t n_boots_expected) {
         sd_journal_close(j);
 
         FOREACH_ARRAY(b, boots, n_boots) {
+                assert_se(b->first_usec <= b->last_usec);
+                if (b > boots)
+                        assert_se(b[-1].last_usec < b->first_usec);
+
                 assert_ret(sd_journal_open_directory(&j, t, 0));
                 assert_se(journal_find_boot_by_id(j, b->id) == 1);
                 sd_journal_close(j);
@@ -7,9 +7,12 @@
 #include "iovec-util.h"
 #include "journal-authenticate.h"
 #include "journal-file-util.h"
+#include "journal-internal.h"
 #include "journal-vacuum.h"
 #include "log.h"
+#include "memory-util.h"
 #include "rm-rf.h"
+#include "string-util.h"
 #include "tests.h"
 
 static bool arg_keep = false;
@@ -126,6 +129,171 @@ TEST(non_empty) {
         test_non_empty_one();
 }
 
+static void test_rewrite_one(void) {
+        _cleanup_(mmap_cache_unrefp) MMapCache *m = NULL;
+        char payload[STRLEN("PAYLOAD=") + 4096];
+        uint64_t p = 0, freed = 0;
+        sd_id128_t seqnum_id;
+        dual_timestamp ts;
+        JournalFile *f;
+        Object *o, *d;
+        char t[] = "/var/tmp/journal-XXXXXX";
+        int r;
+
+        m = mmap_cache_new();
+        assert_se(m != NULL);
+
+        mkdtemp_chdir_chattr(t);
+
+        /* Write an archived, uncompressed journal file with well compressible payloads */
+        assert_se(journal_file_open(-1, "test.journal", O_RDWR|O_CREAT, 0, 0666, UINT64_MAX, NULL, m, NULL, &f) == 0);
+
+        memcpy(payload, "PAYLOAD=", STRLEN("PAYLOAD="));
+        for (unsigned i = 0; i < 16; i++) {
+                struct iovec iovec[2];
+
+                memset(payload + STRLEN("PAYLOAD="), 'a' + i, sizeof(payload) - STRLEN("PAYLOAD="));
+                iovec[0] = IOVEC_MAKE_STRING("COMMON=1");
+                iovec[1] = IOVEC_MAKE(payload, sizeof(payload));
+
+                assert_se(dual_timestamp_now(&ts));
+                assert_se(journal_file_append_entry(f, &ts, NULL, iovec, ELEMENTSOF(iovec), NULL, NULL, NULL, NULL) == 0);
+        }
+
+        seqnum_id = f->header->seqnum_id;
+        f->archive = true;
+        (void) journal_file_offline_close(f);
+
+        assert_se(journal_file_open(-1, "test.journal", O_RDONLY, 0, 0, UINT64_MAX, NULL, m, NULL, &f) == 0);
+        r = journal_file_rewrite(f, JOURNAL_COMPRESS, UINT64_MAX, m, &freed);
+        log_info("Rewriting the journal file freed %"PRIu64" bytes.", freed);
+        (void) journal_file_close(f);
+
+        /* The payloads compress well, hence the rewritten file must be smaller and replace the original */
+        assert_se(r > 0);
+        assert_se(freed > 0);
+
+        assert_se(journal_file_open(-1, "test.journal", O_RDONLY, 0, 0, UINT64_MAX, NULL, m, NULL, &f) == 0);
+        assert_se(f->header->state == STATE_ARCHIVED);
+        assert_se(sd_id128_equal(f->header->seqnum_id, seqnum_id));
+        assert_se(le64toh(f->header->n_entries) == 16);
+
+        for (uint64_t i = 1; i <= 16; i++) {
+                assert_se(journal_file_next_entry(f, p, DIRECTION_DOWN, &o, &p) == 1);
+                assert_se(le64toh(o->entry.seqnum) == i);
+        }
+        assert_se(journal_file_next_entry(f, p, DIRECTION_DOWN, &o, &p) == 0);
+
+        assert_se(journal_file_find_data_object(f, "COMMON=1", STRLEN("COMMON=1"), &d, NULL) == 1);
+        assert_se(le64toh(d->data.n_entries) == 16);
+
+        (void) journal_file_close(f);
+
+        assert_se(rm_rf(t, REMOVE_ROOT|REMOVE_PHYSICAL) >= 0);
+}
+
+TEST(rewrite) {
+        assert_se(setenv("SYSTEMD_JOURNAL_COMPACT", "0", 1) >= 0);
+        test_rewrite_one();
+
+        assert_se(setenv("SYSTEMD_JOURNAL_COMPACT", "1", 1) >= 0);
+        test_rewrite_one();
+}
+
+static unsigned count_matching(sd_journal *j, const char *parity) {
+        unsigned n = 0;
+
+        assert_se(sd_journal_seek_head(j) >= 0);
+
+        while (sd_journal_next(j) > 0) {
+                const void *data;
+                size_t size;
+
+                assert_se(sd_journal_get_data(j, "PARITY", &data, &size) >= 0);
+                assert_se(memcmp_nn(data, size, parity, strlen(parity)) == 0);
+                n++;
+        }
+
+        return n;
+}
+
+TEST(match_cache) {
+        _cleanup_(mmap_cache_unrefp) MMapCache *m = NULL;
+        _cleanup_(sd_journal_closep) sd_journal *j = NULL;
+        uint64_t *cached, even, odd;
+        dual_timestamp ts;
+        JournalFile *f;
+        char t[] = "/var/tmp/journal-XXXXXX";
+
+        m = mmap_cache_new();
+        assert_se(m != NULL);
+
+        mkdtemp_chdir_chattr(t);
+
+        assert_se(journal_file_open(-1, "test.journal", O_RDWR|O_CREAT, 0, 0666, UINT64_MAX, NULL, m, NULL, &f) == 0);
+
+        for (unsigned i = 0; i < 10; i++) {
+                char number[STRLEN("NUMBER=") + DECIMAL_STR_MAX(unsigned)];
+                struct iovec iovec[2];
+
+                xsprintf(number, "NUMBER=%u", i);
+                iovec[0] = IOVEC_MAKE_STRING(number);
+                iovec[1] = IOVEC_MAKE_STRING(i % 2 == 0 ? "PARITY=even" : "PARITY=odd");
+
+                assert_se(dual_timestamp_now(&ts));
+                assert_se(journal_file_append_entry(f, &ts, NULL, iovec, ELEMENTSOF(iovec), NULL, NULL, NULL, NULL) == 0);
+        }
+
+        f->archive = true;
+        (void) journal_file_offline_close(f);
+
+        assert_se(sd_journal_open_directory(&j, t, 0) >= 0);
+        assert_se(f = ordered_hashmap_first(j->files));
+
+        assert_se(journal_file_find_data_object(f, "PARITY=even", STRLEN("PARITY=even"), NULL, &even) == 1);
+        assert_se(journal_file_find_data_object(f, "PARITY=odd", STRLEN("PARITY=odd"), NULL, &odd) == 1);
+
+        /* The first lookup populates the cache */
+        assert_se(sd_journal_add_match(j, "PARITY=even", 0) >= 0);
+        assert_se(count_matching(j, "PARITY=even") == 5);
+        assert_se(hashmap_size(f->match_cache) == 1);
+        assert_se(cached = hashmap_first(f->match_cache));
+        assert_se(*cached == even);
+
+        /* Later lookups for the same match are answered from the cache, hence if we point it elsewhere,
+         * the entries of the other object are returned. */
+        *cached = odd;
+        assert_se(count_matching(j, "PARITY=odd") == 5);
+        assert_se(hashmap_size(f->match_cache) == 1);
+        assert_se(hashmap_first(f->match_cache) == cached);
+        *cached = even;
+        assert_se(count_matching(j, "PARITY=even") == 5);
+
+        /* Flushing the matches drops the cache, so that new matches don't pick up stale offsets */
+        sd_journal_flush_matches(j);
+        assert_se(hashmap_isempty(f->match_cache));
+
+        assert_se(sd_journal_add_match(j, "PARITY=odd", 0) >= 0);
+        assert_se(count_matching(j, "PARITY=odd") == 5);
+        assert_se(hashmap_size(f->match_cache) == 1);
+        assert_se(*(uint64_t*) hashmap_first(f->match_cache) == odd);
+
+        assert_se(sd_journal_add_match(j, "NUMBER=3", 0) >= 0);
+        assert_se(count_matching(j, "PARITY=odd") == 1);
+        assert_se(hashmap_size(f->match_cache) == 2);
+
+        /* Archived files also remember that they don't contain the data at all */
+        sd_journal_flush_matches(j);
+        assert_se(sd_journal_add_match(j, "PARITY=none", 0) >= 0);
+        assert_se(count_matching(j, "PARITY=none") == 0);
+        assert_se(hashmap_size(f->match_cache) == 1);
+        assert_se(*(uint64_t*) hashmap_first(f->match_cache) == 0);
+
+        sd_journal_close(TAKE_PTR(j));
+
+        assert_se(rm_rf(t, REMOVE_ROOT|REMOVE_PHYSICAL) >= 0);
+}
+
 static void test_empty_one(void) {
         _cleanup_(mmap_cache_unrefp) MMapCache *m = NULL;
         JournalFile *f1, *f2, *f3, *f4;
@@ -12,7 +12,8 @@
 #include "tmpfile-util.h"
 
 int main(int argc, char *argv[]) {
-        MMapFileDescriptor *fx;
+        MMapFileDescriptor *fx, *fy;
+        MMapCacheStats stats, seq;
         int x, y, z, r;
         char px[] = "/tmp/testmmapXXXXXXX", py[] = "/tmp/testmmapYXXXXXX", pz[] = "/tmp/testmmapZXXXXXX";
         MMapCache *m;
@@ -57,6 +58,26 @@ int main(int argc, char *argv[]) {
 
         assert_se((uint8_t*) p + 1 == (uint8_t*) q);
 
+        mmap_cache_get_stats(m, &stats);
+        assert_se(stats.n_missed == 2);
+        assert_se(stats.n_category_cache_hit == 1);
+        assert_se(stats.n_window_list_hit == 2);
+        assert_se(stats.n_windows > 0);
+        assert_se(stats.window_bytes > 0);
+
+        /* Scanning through a file sequentially should be detected as such on every miss but the first */
+        assert_se(mmap_cache_add_fd(m, y, PROT_READ, &fy) > 0);
+
+        for (uint64_t o = 0; o < 32ULL*1024ULL*1024ULL; o += 64) {
+                r = mmap_cache_fd_get(fy, 2, false, o, 64, NULL, &p);
+                assert_se(r >= 0);
+        }
+
+        mmap_cache_get_stats(m, &seq);
+        assert_se(seq.n_missed > stats.n_missed + 1);
+        assert_se(seq.n_sequential - stats.n_sequential == seq.n_missed - stats.n_missed - 1);
+
+        mmap_cache_fd_free(fy);
         mmap_cache_fd_free(fx);
         mmap_cache_unref(m);
 
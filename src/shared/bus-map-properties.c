@@ -249,3 +249,113 @@ int bus_map_all_properties(
 
         return r;
 }
+
+typedef struct GetAllCall {
+        sd_bus_slot *slot;
+        sd_bus_message *reply;
+        size_t *n_pending;
+} GetAllCall;
+
+static int on_get_all_reply(sd_bus_message *m, void *userdata, sd_bus_error *ret_error) {
+        GetAllCall *c = ASSERT_PTR(userdata);
+
+        assert(m);
+        assert(*c->n_pending > 0);
+
+        (*c->n_pending)--;
+        c->slot = sd_bus_slot_unref(c->slot);
+
+        /* Failed calls are left without reply, so that the caller can retry them synchronously to get at
+         * the error. */
+        if (!sd_bus_message_is_method_error(m, NULL))
+                c->reply = sd_bus_message_ref(m);
+
+        return 0;
+}
+
+static void get_all_call_done_many(GetAllCall *calls, size_t n) {
+        assert(calls || n == 0);
+
+        FOREACH_ARRAY(c, calls, n) {
+                sd_bus_slot_unref(c->slot);
+                sd_bus_message_unref(c->reply);
+        }
+
+        free(calls);
+}
+
+int bus_get_all_properties_many(
+                sd_bus *bus,
+                const char *destination,
+                char * const *paths,
+                size_t n_paths,
+                sd_bus_message ***ret_replies) {
+
+        _cleanup_free_ sd_bus_message **replies = NULL;
+        GetAllCall *calls = NULL;
+        size_t n_pending = 0, n_issued = 0;
+        int r;
+
+        assert(bus);
+        assert(destination);
+        assert(paths || n_paths == 0);
+        assert(ret_replies);
+
+        CLEANUP_ARRAY(calls, n_paths, get_all_call_done_many);
+
+        /* Issues GetAll() on all specified objects, keeping up to BUS_GET_ALL_PIPELINE_MAX calls in flight
+         * at the same time instead of waiting for each reply in turn before sending the next call. Returns
+         * an array of n_paths replies, in the order of the specified paths. Objects for which the call
+         * failed get a NULL entry. */
+
+        calls = new0(GetAllCall, n_paths);
+        if (!calls)
+                return -ENOMEM;
+
+        replies = new0(sd_bus_message*, n_paths);
+        if (!replies)
+                return -ENOMEM;
+
+        for (;;) {
+                while (n_issued < n_paths && n_pending < BUS_GET_ALL_PIPELINE_MAX) {
+                        GetAllCall *c = calls + n_issued;
+
+                        c->n_pending = &n_pending;
+
+                        r = sd_bus_call_method_async(
+                                        bus,
+                                        &c->slot,
+                                        destination,
+                                        paths[n_issued],
+                                        "org.freedesktop.DBus.Properties",
+                                        "GetAll",
+                                        on_get_all_reply,
+                                        c,
+                                        "s", "");
+                        if (r < 0)
+                                return r;
+
+                        n_issued++;
+                        n_pending++;
+                }
+
+                if (n_pending == 0)
+                        break;
+
+                r = sd_bus_process(bus, NULL);
+                if (r < 0)
+                        return r;
+                if (r > 0)
+                        continue;
+
+                r = sd_bus_wait(bus, UINT64_MAX);
+                if (r < 0)
+                        return r;
+        }
+
+        for (size_t i = 0; i < n_paths; i++)
+                replies[i] = TAKE_PTR(calls[i].reply);
+
+        *ret_replies = TAKE_PTR(replies);
+        return 0;
+}
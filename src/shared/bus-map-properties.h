@@ -23,3 +23,8 @@ int bus_map_strv_sort(sd_bus *bus, const char *member, sd_bus_message *m, sd_bus
 int bus_message_map_all_properties(sd_bus_message *m, const struct bus_properties_map *map, unsigned flags, sd_bus_error *error, void *userdata);
 int bus_map_all_properties(sd_bus *bus, const char *destination, const char *path, const struct bus_properties_map *map,
                            unsigned flags, sd_bus_error *error, sd_bus_message **reply, void *userdata);
+
+/* Maximum number of GetAll() calls bus_get_all_properties_many() keeps in flight at the same time */
+#define BUS_GET_ALL_PIPELINE_MAX 64U
+
+int bus_get_all_properties_many(sd_bus *bus, const char *destination, char * const *paths, size_t n_paths, sd_bus_message ***ret_replies);
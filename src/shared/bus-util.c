@@ -673,6 +673,15 @@ const struct hash_ops bus_message_hash_ops = {
         .free_value = bus_message_unref_wrapper,
 };
 
+void bus_message_unref_many(sd_bus_message **array, size_t n) {
+        assert(array || n == 0);
+
+        FOREACH_ARRAY(m, array, n)
+                sd_bus_message_unref(*m);
+
+        free(array);
+}
+
 int bus_message_append_string_set(sd_bus_message *m, Set *set) {
         const char *s;
         int r;
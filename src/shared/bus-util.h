@@ -70,6 +70,8 @@ int bus_register_malloc_status(sd_bus *bus, const char *destination);
 
 extern const struct hash_ops bus_message_hash_ops;
 
+void bus_message_unref_many(sd_bus_message **array, size_t n);
+
 int bus_message_append_string_set(sd_bus_message *m, Set *s);
 
 int bus_property_get_string_set(sd_bus *bus, const char *path, const char *interface, const char *property, sd_bus_message *reply, void *userdata, sd_bus_error *error);
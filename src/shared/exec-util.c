@@ -17,8 +17,10 @@
 #include "fd-util.h"
 #include "fileio.h"
 #include "hashmap.h"
+#include "io-util.h"
 #include "macro.h"
 #include "missing_syscall.h"
+#include "parse-util.h"
 #include "path-util.h"
 #include "process-util.h"
 #include "serialize.h"
@@ -79,6 +81,36 @@ static int do_spawn(const char *path, char *argv[], int stdout_fd, pid_t *pid, b
         return 1;
 }
 
+typedef struct ExecChild {
+        usec_t start_usec;
+        char path[];
+} ExecChild;
+
+static void report_timing(const char *path, usec_t start_usec, int timings_fd) {
+        _cleanup_free_ char *line = NULL;
+        usec_t duration;
+        int r;
+
+        assert(path);
+
+        duration = usec_sub_unsigned(now(CLOCK_MONOTONIC), start_usec);
+
+        log_debug("%s finished after %s.", path, FORMAT_TIMESPAN(duration, USEC_PER_MSEC));
+
+        if (timings_fd < 0)
+                return;
+
+        /* One line per executable, the path comes last so that it may contain spaces */
+        if (asprintf(&line, USEC_FMT " %s\n", duration, path) < 0) {
+                log_oom_debug();
+                return;
+        }
+
+        r = loop_write(timings_fd, line, SIZE_MAX);
+        if (r < 0)
+                log_debug_errno(r, "Failed to write timing information of %s, ignoring: %m", path);
+}
+
 static int do_execute(
                 char* const* paths,
                 const char *root,
@@ -88,7 +120,8 @@ static int do_execute(
                 int output_fd,
                 char *argv[],
                 char *envp[],
-                ExecDirFlags flags) {
+                ExecDirFlags flags,
+                int timings_fd) {
 
         _cleanup_hashmap_free_free_ Hashmap *pids = NULL;
         bool parallel_execution;
@@ -121,6 +154,7 @@ static int do_execute(
         STRV_FOREACH(path, paths) {
                 _cleanup_free_ char *t = NULL;
                 _cleanup_close_ int fd = -EBADF;
+                usec_t start_usec;
                 pid_t pid;
 
                 t = path_join(root, *path);
@@ -159,21 +193,35 @@ static int do_execute(
                                             "permission bits. Proceeding anyway.", t);
                 }
 
+                start_usec = now(CLOCK_MONOTONIC);
+
                 r = do_spawn(t, argv, fd, &pid, FLAGS_SET(flags, EXEC_DIR_SET_SYSTEMD_EXEC_PID));
                 if (r <= 0)
                         continue;
 
                 if (parallel_execution) {
-                        r = hashmap_put(pids, PID_TO_PTR(pid), t);
+                        _cleanup_free_ ExecChild *c = NULL;
+                        size_t l = strlen(t);
+
+                        c = malloc(offsetof(ExecChild, path) + l + 1);
+                        if (!c)
+                                return log_oom();
+
+                        c->start_usec = start_usec;
+                        memcpy(c->path, t, l + 1);
+
+                        r = hashmap_put(pids, PID_TO_PTR(pid), c);
                         if (r < 0)
                                 return log_oom();
-                        t = NULL;
+                        TAKE_PTR(c);
                 } else {
                         bool skip_remaining = false;
 
                         r = wait_for_terminate_and_check(t, pid, WAIT_LOG_ABNORMAL);
                         if (r < 0)
                                 return r;
+
+                        report_timing(t, start_usec, timings_fd);
                         if (r > 0) {
                                 if (FLAGS_SET(flags, EXEC_DIR_SKIP_REMAINING) && r == EXIT_SKIP_REMAINING) {
                                         log_info("%s succeeded with exit status %i, not executing remaining executables.", *path, r);
@@ -207,18 +255,35 @@ static int do_execute(
         }
 
         while (!hashmap_isempty(pids)) {
-                _cleanup_free_ char *t = NULL;
+                _cleanup_free_ ExecChild *c = NULL;
+                siginfo_t si = {};
                 pid_t pid;
 
-                pid = PTR_TO_PID(hashmap_first_key(pids));
+                /* Pick up the children in the order they finish, so that we know how long each of them
+                 * ran. The child is only reaped below, by wait_for_terminate_and_check(). */
+                if (waitid(P_ALL, 0, &si, WEXITED|WNOWAIT) < 0) {
+                        if (errno == EINTR)
+                                continue;
+
+                        return log_error_errno(errno, "Failed to wait for executables to finish: %m");
+                }
+
+                pid = si.si_pid;
                 assert(pid > 0);
 
-                t = hashmap_remove(pids, PID_TO_PTR(pid));
-                assert(t);
+                c = hashmap_remove(pids, PID_TO_PTR(pid));
+                if (!c) {
+                        /* Not one of ours? Reap it anyway, so that we don't pick it up again. */
+                        (void) wait_for_terminate(pid, NULL);
+                        continue;
+                }
 
-                r = wait_for_terminate_and_check(t, pid, WAIT_LOG);
+                r = wait_for_terminate_and_check(c->path, pid, WAIT_LOG);
                 if (r < 0)
                         return r;
+
+                report_timing(c->path, c->start_usec, timings_fd);
+
                 if (!FLAGS_SET(flags, EXEC_DIR_IGNORE_ERRORS) && r > 0)
                         return r;
         }
@@ -226,7 +291,7 @@ static int do_execute(
         return 0;
 }
 
-int execute_strv(
+int execute_strv_full(
                 const char *name,
                 char* const* paths,
                 const char *root,
@@ -235,7 +300,8 @@ int execute_strv(
                 void* const callback_args[_STDOUT_CONSUME_MAX],
                 char *argv[],
                 char *envp[],
-                ExecDirFlags flags) {
+                ExecDirFlags flags,
+                int timings_fd) {
 
         _cleanup_close_ int fd = -EBADF;
         pid_t executor_pid;
@@ -260,13 +326,14 @@ int execute_strv(
 
         /* Executes all binaries in the directories serially or in parallel and waits for
          * them to finish. Optionally a timeout is applied. If a file with the same name
-         * exists in more than one directory, the earliest one wins. */
+         * exists in more than one directory, the earliest one wins. If timings_fd is valid,
+         * the runtime of each binary is written to it, see exec_timings_read(). */
 
         r = safe_fork("(sd-exec-strv)", FORK_RESET_SIGNALS|FORK_DEATHSIG_SIGTERM|FORK_LOG, &executor_pid);
         if (r < 0)
                 return r;
         if (r == 0) {
-                r = do_execute(paths, root, timeout, callbacks, callback_args, fd, argv, envp, flags);
+                r = do_execute(paths, root, timeout, callbacks, callback_args, fd, argv, envp, flags, timings_fd);
                 _exit(r < 0 ? EXIT_FAILURE : r);
         }
 
@@ -288,14 +355,15 @@ int execute_strv(
         return 0;
 }
 
-int execute_directories(
+int execute_directories_full(
                 const char* const* directories,
                 usec_t timeout,
                 gather_stdout_callback_t const callbacks[_STDOUT_CONSUME_MAX],
                 void* const callback_args[_STDOUT_CONSUME_MAX],
                 char *argv[],
                 char *envp[],
-                ExecDirFlags flags) {
+                ExecDirFlags flags,
+                int timings_fd) {
 
         _cleanup_strv_free_ char **paths = NULL;
         _cleanup_free_ char *name = NULL;
@@ -318,7 +386,83 @@ int execute_directories(
                         return log_error_errno(r, "Failed to extract file name from '%s': %m", directories[0]);
         }
 
-        return execute_strv(name, paths, NULL, timeout, callbacks, callback_args, argv, envp, flags);
+        return execute_strv_full(name, paths, NULL, timeout, callbacks, callback_args, argv, envp, flags, timings_fd);
+}
+
+void exec_timing_free_many(ExecTiming *timings, size_t n) {
+        assert(timings || n == 0);
+
+        FOREACH_ARRAY(t, timings, n)
+                free(t->path);
+
+        free(timings);
+}
+
+int exec_timings_read(int fd, ExecTiming **ret, size_t *ret_n) {
+        _cleanup_fclose_ FILE *f = NULL;
+        ExecTiming *timings = NULL;
+        size_t n = 0;
+        int r;
+
+        CLEANUP_ARRAY(timings, n, exec_timing_free_many);
+
+        assert(fd >= 0);
+        assert(ret);
+        assert(ret_n);
+
+        /* Parses the timing information written by execute_strv_full() to its timings_fd, from the
+         * beginning of the file. Takes possession of the fd. */
+
+        f = take_fdopen(&fd, "r");
+        if (!f) {
+                safe_close(fd);
+                return -errno;
+        }
+
+        if (fseeko(f, 0, SEEK_SET) < 0)
+                return -errno;
+
+        for (;;) {
+                _cleanup_free_ char *line = NULL;
+                char *path;
+                usec_t duration;
+
+                r = read_line(f, LONG_LINE_MAX, &line);
+                if (r < 0)
+                        return r;
+                if (r == 0)
+                        break;
+
+                path = strchr(line, ' ');
+                if (!path) {
+                        log_debug("Invalid timing line '%s', ignoring.", line);
+                        continue;
+                }
+
+                *(path++) = '\0';
+
+                r = safe_atou64(line, &duration);
+                if (r < 0) {
+                        log_debug_errno(r, "Failed to parse duration '%s', ignoring: %m", line);
+                        continue;
+                }
+
+                if (!GREEDY_REALLOC(timings, n + 1))
+                        return -ENOMEM;
+
+                timings[n] = (ExecTiming) {
+                        .path = strdup(path),
+                        .duration = duration,
+                };
+                if (!timings[n].path)
+                        return -ENOMEM;
+
+                n++;
+        }
+
+        *ret_n = n;
+        *ret = TAKE_PTR(timings);
+        return 0;
 }
 
 static int gather_environment_generate(int fd, void *arg) {
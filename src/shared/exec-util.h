@@ -32,7 +32,23 @@ typedef enum ExecCommandFlags {
         _EXEC_COMMAND_FLAGS_INVALID   = -EINVAL,
 } ExecCommandFlags;
 
-int execute_strv(
+typedef struct ExecTiming {
+        char *path;
+        usec_t duration;
+} ExecTiming;
+
+int execute_strv_full(
+                const char *name,
+                char* const* paths,
+                const char *root,
+                usec_t timeout,
+                gather_stdout_callback_t const callbacks[_STDOUT_CONSUME_MAX],
+                void* const callback_args[_STDOUT_CONSUME_MAX],
+                char *argv[],
+                char *envp[],
+                ExecDirFlags flags,
+                int timings_fd);
+static inline int execute_strv(
                 const char *name,
                 char* const* paths,
                 const char *root,
@@ -41,16 +57,32 @@ int execute_strv(
                 void* const callback_args[_STDOUT_CONSUME_MAX],
                 char *argv[],
                 char *envp[],
-                ExecDirFlags flags);
+                ExecDirFlags flags) {
+        return execute_strv_full(name, paths, root, timeout, callbacks, callback_args, argv, envp, flags, -EBADF);
+}
 
-int execute_directories(
+int execute_directories_full(
+                const char* const* directories,
+                usec_t timeout,
+                gather_stdout_callback_t const callbacks[_STDOUT_CONSUME_MAX],
+                void* const callback_args[_STDOUT_CONSUME_MAX],
+                char *argv[],
+                char *envp[],
+                ExecDirFlags flags,
+                int timings_fd);
+static inline int execute_directories(
                 const char* const* directories,
                 usec_t timeout,
                 gather_stdout_callback_t const callbacks[_STDOUT_CONSUME_MAX],
                 void* const callback_args[_STDOUT_CONSUME_MAX],
                 char *argv[],
                 char *envp[],
-                ExecDirFlags flags);
+                ExecDirFlags flags) {
+        return execute_directories_full(directories, timeout, callbacks, callback_args, argv, envp, flags, -EBADF);
+}
+
+void exec_timing_free_many(ExecTiming *timings, size_t n);
+int exec_timings_read(int fd, ExecTiming **ret, size_t *ret_n);
 
 int exec_command_flags_from_strv(char **ex_opts, ExecCommandFlags *flags);
 int exec_command_flags_to_strv(ExecCommandFlags flags, char ***ex_opts);
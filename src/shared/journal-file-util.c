@@ -8,6 +8,7 @@
 #include "errno-util.h"
 #include "fd-util.h"
 #include "format-util.h"
+#include "fs-util.h"
 #include "journal-authenticate.h"
 #include "journal-file-util.h"
 #include "path-util.h"
@@ -15,6 +16,7 @@
 #include "set.h"
 #include "stat-util.h"
 #include "sync-util.h"
+#include "tmpfile-util.h"
 
 #define PAYLOAD_BUFFER_SIZE (16U * 1024U)
 #define MINIMUM_HOLE_SIZE (1U * 1024U * 1024U / 2U)
@@ -537,3 +539,162 @@ int journal_file_open_reliably(
         return journal_file_open(-1, fname, open_flags, file_flags, mode, compress_threshold_bytes, metrics,
                                  mmap_cache, template, ret);
 }
+
+int journal_file_rewrite(
+                JournalFile *from,
+                JournalFileFlags file_flags,
+                uint64_t compress_threshold_bytes,
+                MMapCache *mmap_cache,
+                uint64_t *ret_freed) {
+
+        _cleanup_(journal_file_offline_closep) JournalFile *to = NULL;
+        _cleanup_(unlink_and_freep) char *tmp = NULL;
+        _cleanup_free_ char *t = NULL;
+        _cleanup_close_ int fd = -EBADF, fd_copy = -EBADF;
+        JournalMetrics metrics;
+        struct stat st, current;
+        uint64_t p = 0, end, size;
+        Object *o;
+        int r;
+
+        assert(from);
+        assert(from->header);
+        assert(mmap_cache);
+
+        /* Writes the entries of an archived journal file into a new file, and replaces the original with it
+         * if that saves disk space. The new file uses the current defaults for compression, keyed hashes
+         * and compact mode, and hash tables sized for the amount of data actually stored, instead of for
+         * the maximum file size that was configured when the original was written. Returns 1 if the file
+         * was replaced, 0 if not. */
+
+        if (from->header->state != STATE_ARCHIVED)
+                return log_debug_errno(SYNTHETIC_ERRNO(EBUSY),
+                                       "%s: Journal file is not archived, refusing to rewrite.", from->path);
+
+        /* The rewritten file would fail verification against the FSS key. */
+        if (JOURNAL_HEADER_SEALED(from->header))
+                return log_debug_errno(SYNTHETIC_ERRNO(EPERM),
+                                       "%s: Journal file is sealed, refusing to rewrite.", from->path);
+
+        /* journal_file_open() refuses files that are not linked into the file system, hence we cannot use
+         * O_TMPFILE here, but write to a file with a temporary name next to the original. */
+        r = tempfn_random(from->path, NULL, &t);
+        if (r < 0)
+                return log_oom_debug();
+
+        fd = open(t, O_RDWR|O_CREAT|O_EXCL|O_CLOEXEC|O_NOCTTY, 0640);
+        if (fd < 0)
+                return log_debug_errno(errno, "%s: Failed to create temporary file: %m", from->path);
+
+        tmp = TAKE_PTR(t);
+
+        /* Archived files should not have NOCOW set, and we need to turn that off (if inherited from the
+         * directory) before writing any data, as otherwise archiving would copy the file once more. */
+        r = chattr_fd(fd, 0, FS_NOCOW_FL, NULL);
+        if (r < 0)
+                log_debug_errno(r, "%s: Failed to disable NOCOW on temporary file, ignoring: %m", from->path);
+
+        /* The journal file takes possession of the fd it is opened on, but we need ours to link the file
+         * into place once it is complete. */
+        fd_copy = fcntl(fd, F_DUPFD_CLOEXEC, 3);
+        if (fd_copy < 0)
+                return -errno;
+
+        /* Size the new file, and hence its hash tables, for the disk space the original actually uses.
+         * Its size is rounded up to the allocation increment, the unused tail of which was punched out
+         * when it was archived. */
+        journal_reset_metrics(&metrics);
+        metrics.max_size = (uint64_t) from->last_stat.st_blocks * 512U;
+
+        r = journal_file_open(
+                        fd_copy,
+                        from->path,
+                        O_RDWR,
+                        file_flags,
+                        from->last_stat.st_mode & 07777,
+                        compress_threshold_bytes,
+                        &metrics,
+                        mmap_cache,
+                        /* template= */ NULL,
+                        &to);
+        if (r < 0)
+                return log_debug_errno(r, "%s: Failed to open temporary journal file: %m", from->path);
+
+        TAKE_FD(fd_copy);
+
+        to->header->machine_id = from->header->machine_id;
+
+        for (;;) {
+                sd_id128_t seqnum_id = from->header->seqnum_id;
+                uint64_t seqnum;
+
+                r = journal_file_next_entry(from, p, DIRECTION_DOWN, &o, &p);
+                if (r < 0)
+                        return log_debug_errno(r, "%s: Failed to read entry: %m", from->path);
+                if (r == 0)
+                        break;
+
+                /* Keep the sequence numbers, the file name and vacuuming logic are based on them. */
+                seqnum = LESS_BY(le64toh(o->entry.seqnum), UINT64_C(1));
+
+                r = journal_file_copy_entry(from, to, o, p, &seqnum, &seqnum_id);
+                if (r == -E2BIG) {
+                        log_debug("%s: Rewritten journal file would be larger than the original, leaving it as is.",
+                                  from->path);
+                        return 0;
+                }
+                if (r < 0)
+                        return log_debug_errno(r, "%s: Failed to copy entry: %m", from->path);
+        }
+
+        r = journal_file_tail_end_by_mmap(to, &end);
+        if (r < 0)
+                return log_debug_errno(r, "%s: Failed to determine end of rewritten journal file: %m", from->path);
+
+        size = to->last_stat.st_size;
+
+        to->archive = true;
+        to = journal_file_offline_close(to);
+
+        /* The file was allocated in large increments, but nothing is ever going to be appended to it, hence
+         * release the space beyond the last object, however small it is. */
+        if (end < size &&
+            fallocate(fd, FALLOC_FL_PUNCH_HOLE|FALLOC_FL_KEEP_SIZE, end, size - end) < 0)
+                log_debug_errno(errno, "%s: Failed to punch hole at end of rewritten journal file, ignoring: %m",
+                                from->path);
+
+        if (fstat(fd, &st) < 0)
+                return -errno;
+
+        if (st.st_blocks >= from->last_stat.st_blocks) {
+                log_debug("%s: Rewritten journal file would not save any disk space, leaving it as is.", from->path);
+                return 0;
+        }
+
+        r = copy_rights(from->fd, fd);
+        if (r < 0)
+                return log_debug_errno(r, "%s: Failed to copy ownership and access mode: %m", from->path);
+
+        /* This also carries over the creation time the vacuuming logic looks at, and any ACLs. */
+        r = copy_xattr(from->fd, NULL, fd, NULL, COPY_ALL_XATTRS);
+        if (r < 0)
+                log_debug_errno(r, "%s: Failed to copy extended attributes, ignoring: %m", from->path);
+
+        /* Don't resurrect the file if it was vacuumed or otherwise replaced in the meantime. */
+        if (stat(from->path, &current) < 0)
+                return log_debug_errno(errno, "%s: Failed to check if journal file still exists: %m", from->path);
+        if (!stat_inode_same(&current, &from->last_stat))
+                return log_debug_errno(SYNTHETIC_ERRNO(ESTALE),
+                                       "%s: Journal file was replaced while rewriting it.", from->path);
+
+        r = link_tmpfile(fd, tmp, from->path, LINK_TMPFILE_REPLACE|LINK_TMPFILE_SYNC);
+        if (r < 0)
+                return log_debug_errno(r, "%s: Failed to move rewritten journal file into place: %m", from->path);
+
+        tmp = mfree(tmp);
+
+        if (ret_freed)
+                *ret_freed = (uint64_t) (from->last_stat.st_blocks - st.st_blocks) * 512U;
+
+        return 1;
+}
@@ -27,3 +27,10 @@ int journal_file_rotate(
                 JournalFileFlags file_flags,
                 uint64_t compress_threshold_bytes,
                 Set *deferred_closes);
+
+int journal_file_rewrite(
+                JournalFile *from,
+                JournalFileFlags file_flags,
+                uint64_t compress_threshold_bytes,
+                MMapCache *mmap_cache,
+                uint64_t *ret_freed);
@@ -940,7 +940,8 @@ void json_escape(
 
 typedef struct JsonData {
         JsonVariant* name;
-        JsonVariant* values;
+        JsonVariant* value;  /* If the field is set more than once, this is an array of all values */
+        size_t n_values;
 } JsonData;
 
 static JsonData* json_data_free(JsonData *d) {
@@ -948,7 +949,7 @@ static JsonData* json_data_free(JsonData *d) {
                 return NULL;
 
         json_variant_unref(d->name);
-        json_variant_unref(d->values);
+        json_variant_unref(d->value);
 
         return mfree(d);
 }
@@ -987,9 +988,18 @@ static int update_json_data(
 
         d = hashmap_get(h, name);
         if (d) {
-                r = json_variant_append_array(&d->values, v);
+                /* Most fields are set only once per entry, hence only wrap the values in an array once
+                 * we see a second one, instead of allocating an array for every single field. */
+                if (d->n_values == 1) {
+                        _cleanup_(json_variant_unrefp) JsonVariant *first = TAKE_PTR(d->value);
+
+                        r = json_variant_new_array(&d->value, (JsonVariant*[]) { first, v }, 2);
+                } else
+                        r = json_variant_append_array(&d->value, v);
                 if (r < 0)
                         return log_error_errno(r, "Failed to append JSON value into array: %m");
+
+                d->n_values++;
         } else {
                 _cleanup_(json_data_freep) JsonData *e = NULL;
 
@@ -1001,9 +1011,8 @@ static int update_json_data(
                 if (r < 0)
                         return log_error_errno(r, "Failed to allocate JSON name variant: %m");
 
-                r = json_variant_append_array(&e->values, v);
-                if (r < 0)
-                        return log_error_errno(r, "Failed to create JSON value array: %m");
+                e->value = TAKE_PTR(v);
+                e->n_values = 1;
 
                 r = hashmap_put(h, json_variant_string(e->name), e);
                 if (r < 0)
@@ -1153,14 +1162,10 @@ static int output_json(
         CLEANUP_ARRAY(array, n, json_variant_unref_many);
 
         HASHMAP_FOREACH(d, h) {
-                assert(json_variant_elements(d->values) > 0);
+                assert(d->n_values > 0);
 
                 array[n++] = json_variant_ref(d->name);
-
-                if (json_variant_elements(d->values) == 1)
-                        array[n++] = json_variant_ref(json_variant_by_index(d->values, 0));
-                else
-                        array[n++] = json_variant_ref(d->values);
+                array[n++] = json_variant_ref(d->value);
         }
 
         r = json_variant_new_object(&object, array, n);
@@ -2007,7 +2012,7 @@ int journal_find_boot_by_id(sd_journal *j, sd_id128_t boot_id) {
         return r > 0;
 }
 
-int journal_find_boot_by_offset(sd_journal *j, int offset, sd_id128_t *ret) {
+static int journal_find_boot_by_offset_walking(sd_journal *j, int offset, sd_id128_t *ret) {
         bool advance_older;
         int r;
 
@@ -2054,7 +2059,7 @@ int journal_find_boot_by_offset(sd_journal *j, int offset, sd_id128_t *ret) {
         return true;
 }
 
-int journal_get_boots(sd_journal *j, BootId **ret_boots, size_t *ret_n_boots) {
+static int journal_get_boots_walking(sd_journal *j, BootId **ret_boots, size_t *ret_n_boots) {
         _cleanup_free_ BootId *boots = NULL;
         size_t n_boots = 0;
         int r;
@@ -2101,3 +2106,52 @@ int journal_get_boots(sd_journal *j, BootId **ret_boots, size_t *ret_n_boots) {
         *ret_n_boots = n_boots;
         return n_boots > 0;
 }
+
+int journal_find_boot_by_offset(sd_journal *j, int offset, sd_id128_t *ret) {
+        _cleanup_free_ BootId *boots = NULL;
+        size_t n_boots;
+        int r;
+
+        assert(j);
+        assert(ret);
+
+        r = journal_get_boots_from_index(j, &boots, &n_boots);
+        if (r == -ENOMEM)
+                return r;
+        if (r < 0) {
+                log_debug_errno(r, "Failed to determine boots from the _BOOT_ID= field index, walking the journal instead: %m");
+                return journal_find_boot_by_offset_walking(j, offset, ret);
+        }
+
+        /* Offset 0 is the last (and current) boot, while 1 is considered the (chronological) first boot in
+         * the journal. */
+        int64_t i = offset <= 0 ? (int64_t) n_boots - 1 + offset : (int64_t) offset - 1;
+        if (i < 0 || i >= (int64_t) n_boots) {
+                *ret = SD_ID128_NULL;
+                return false;
+        }
+
+        *ret = boots[i].id;
+        log_debug("Found boot ID %s by offset %i", SD_ID128_TO_STRING(*ret), offset);
+        return true;
+}
+
+int journal_get_boots(sd_journal *j, BootId **ret_boots, size_t *ret_n_boots) {
+        int r;
+
+        assert(j);
+        assert(ret_boots);
+        assert(ret_n_boots);
+
+        /* Use the per-file _BOOT_ID= field index first, which scales with the number of boots in each file
+         * rather than with the number of boots times the number of files. If the index turns out to be
+         * unusable (e.g. due to corruption), or can't order the boots (files with different seqnum IDs),
+         * fall back to stepping through the interleaved journal. */
+
+        r = journal_get_boots_from_index(j, ret_boots, ret_n_boots);
+        if (r >= 0 || r == -ENOMEM)
+                return r;
+
+        log_debug_errno(r, "Failed to determine boots from the _BOOT_ID= field index, walking the journal instead: %m");
+        return journal_get_boots_walking(j, ret_boots, ret_n_boots);
+}
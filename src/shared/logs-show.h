@@ -13,11 +13,7 @@
 #include "output-mode.h"
 #include "time-util.h"
 
-typedef struct BootId {
-        sd_id128_t id;
-        usec_t first_usec;
-        usec_t last_usec;
-} BootId;
+typedef struct BootId BootId;
 
 int show_journal_entry(
                 FILE *f,
@@ -8,6 +8,7 @@
 #include "bus-map-properties.h"
 #include "bus-print-properties.h"
 #include "bus-unit-procs.h"
+#include "bus-util.h"
 #include "cgroup-show.h"
 #include "cpu-set-util.h"
 #include "errno-util.h"
@@ -2014,6 +2015,7 @@ static int show_one(
                 sd_bus *bus,
                 const char *path,
                 const char *unit,
+                sd_bus_message *properties,
                 SystemctlShowMode show_mode,
                 bool *new_line,
                 bool *ellipsized) {
@@ -2162,15 +2164,26 @@ static int show_one(
 
         log_debug("Showing one %s", path);
 
-        r = bus_map_all_properties(
-                        bus,
-                        "org.freedesktop.systemd1",
-                        path,
-                        show_mode == SYSTEMCTL_SHOW_STATUS ? status_map : property_map,
-                        BUS_MAP_BOOLEAN_AS_BOOL,
-                        &error,
-                        &reply,
-                        &info);
+        if (properties) {
+                /* The GetAll() reply has already been acquired by the caller */
+                r = bus_message_map_all_properties(
+                                properties,
+                                show_mode == SYSTEMCTL_SHOW_STATUS ? status_map : property_map,
+                                BUS_MAP_BOOLEAN_AS_BOOL,
+                                &error,
+                                &info);
+                if (r >= 0)
+                        reply = sd_bus_message_ref(properties);
+        } else
+                r = bus_map_all_properties(
+                                bus,
+                                "org.freedesktop.systemd1",
+                                path,
+                                show_mode == SYSTEMCTL_SHOW_STATUS ? status_map : property_map,
+                                BUS_MAP_BOOLEAN_AS_BOOL,
+                                &error,
+                                &reply,
+                                &info);
         if (r < 0)
                 return log_error_errno(r, "Failed to get properties: %s", bus_error_message(&error, r));
 
@@ -2307,6 +2320,55 @@ static int get_unit_dbus_path_by_pid(
         return 0;
 }
 
+static int show_many(
+                sd_bus *bus,
+                char * const *names,
+                size_t n_names,
+                SystemctlShowMode show_mode,
+                bool *new_line,
+                bool *ellipsized) {
+
+        int r, ret = 0;
+
+        assert(names || n_names == 0);
+
+        /* Acquire the properties of the units in batches, pipelining the GetAll() calls of each batch, so
+         * that we don't pay a full round trip to the manager for each unit. */
+
+        for (size_t i = 0; i < n_names; i += BUS_GET_ALL_PIPELINE_MAX) {
+                _cleanup_strv_free_ char **paths = NULL;
+                sd_bus_message **replies = NULL;
+                size_t n = MIN(n_names - i, BUS_GET_ALL_PIPELINE_MAX);
+
+                CLEANUP_ARRAY(replies, n, bus_message_unref_many);
+
+                paths = new0(char*, n + 1);
+                if (!paths)
+                        return log_oom();
+
+                for (size_t j = 0; j < n; j++) {
+                        paths[j] = unit_dbus_path_from_name(names[i + j]);
+                        if (!paths[j])
+                                return log_oom();
+                }
+
+                r = bus_get_all_properties_many(bus, "org.freedesktop.systemd1", paths, n, &replies);
+                if (r < 0)
+                        return log_error_errno(r, "Failed to get unit properties: %m");
+
+                for (size_t j = 0; j < n; j++) {
+                        /* If the call failed, show_one() will retry synchronously, to report the error. */
+                        r = show_one(bus, paths[j], names[i + j], replies[j], show_mode, new_line, ellipsized);
+                        if (r < 0)
+                                return r;
+                        if (r > 0 && ret == 0)
+                                ret = r;
+                }
+        }
+
+        return ret;
+}
+
 static int show_all(
                 sd_bus *bus,
                 SystemctlShowMode show_mode,
@@ -2315,8 +2377,9 @@ static int show_all(
 
         _cleanup_(sd_bus_message_unrefp) sd_bus_message *reply = NULL;
         _cleanup_free_ UnitInfo *unit_infos = NULL;
+        _cleanup_free_ char **names = NULL;
         unsigned c;
-        int r, ret = 0;
+        int r;
 
         r = get_unit_list(bus, NULL, NULL, &unit_infos, 0, &reply);
         if (r < 0)
@@ -2328,21 +2391,14 @@ static int show_all(
 
         typesafe_qsort(unit_infos, c, unit_info_compare);
 
-        for (const UnitInfo *u = unit_infos; u < unit_infos + c; u++) {
-                _cleanup_free_ char *p = NULL;
-
-                p = unit_dbus_path_from_name(u->id);
-                if (!p)
-                        return log_oom();
+        names = new(char*, c);
+        if (!names)
+                return log_oom();
 
-                r = show_one(bus, p, u->id, show_mode, new_line, ellipsized);
-                if (r < 0)
-                        return r;
-                if (r > 0 && ret == 0)
-                        ret = r;
-        }
+        for (unsigned i = 0; i < c; i++)
+                names[i] = (char*) unit_infos[i].id;
 
-        return ret;
+        return show_many(bus, names, c, show_mode, new_line, ellipsized);
 }
 
 static int show_system_status(sd_bus *bus) {
@@ -2448,7 +2504,7 @@ int verb_show(int argc, char *argv[], void *userdata) {
                 if (!arg_states && !arg_types) {
                         if (show_mode == SYSTEMCTL_SHOW_PROPERTIES)
                                 /* systemctl show --all → show properties of the manager */
-                                return show_one(bus, "/org/freedesktop/systemd1", NULL, show_mode, &new_line, &ellipsized);
+                                return show_one(bus, "/org/freedesktop/systemd1", NULL, NULL, show_mode, &new_line, &ellipsized);
 
                         r = show_system_status(bus);
                         if (r < 0)
@@ -2485,7 +2541,7 @@ int verb_show(int argc, char *argv[], void *userdata) {
                                 }
                         }
 
-                        r = show_one(bus, path, unit, show_mode, &new_line, &ellipsized);
+                        r = show_one(bus, path, unit, NULL, show_mode, &new_line, &ellipsized);
                         if (r < 0)
                                 return r;
                         if (r > 0 && ret == 0)
@@ -2503,19 +2559,11 @@ int verb_show(int argc, char *argv[], void *userdata) {
                         if (r < 0)
                                 return r;
 
-                        STRV_FOREACH(name, names) {
-                                _cleanup_free_ char *path = NULL;
-
-                                path = unit_dbus_path_from_name(*name);
-                                if (!path)
-                                        return log_oom();
-
-                                r = show_one(bus, path, *name, show_mode, &new_line, &ellipsized);
-                                if (r < 0)
-                                        return r;
-                                if (r > 0 && ret == 0)
-                                        ret = r;
-                        }
+                        r = show_many(bus, names, strv_length(names), show_mode, &new_line, &ellipsized);
+                        if (r < 0)
+                                return r;
+                        if (r > 0 && ret == 0)
+                                ret = r;
                 }
         }
 
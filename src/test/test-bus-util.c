@@ -1,7 +1,16 @@
 /* SPDX-License-Identifier: LGPL-2.1-or-later */
 
+#include <pthread.h>
+#include <sys/socket.h>
+
+#include "bus-map-properties.h"
 #include "bus-util.h"
+#include "fd-util.h"
 #include "log.h"
+#include "parse-util.h"
+#include "path-util.h"
+#include "string-util.h"
+#include "strv.h"
 #include "tests.h"
 
 static int callback(sd_bus_message *m, void *userdata, sd_bus_error *ret_error) {
@@ -44,4 +53,146 @@ TEST(destroy_callback) {
         assert_se(n_called == 1);
 }
 
+typedef struct GetAllServer {
+        int fd;
+        size_t n_paths;
+} GetAllServer;
+
+static void reply_get_all_many(sd_bus_message **calls, size_t n) {
+        FOREACH_ARRAY(c, calls, n) {
+                _cleanup_(sd_bus_message_unrefp) sd_bus_message *reply = NULL;
+                uint64_t index;
+
+                assert_se(sd_bus_message_is_method_call(*c, "org.freedesktop.DBus.Properties", "GetAll") > 0);
+                assert_se(path_startswith(sd_bus_message_get_path(*c), "/test/"));
+                assert_se(safe_atou64(sd_bus_message_get_path(*c) + STRLEN("/test/"), &index) >= 0);
+
+                /* Fail some calls, to check that they get a NULL reply */
+                if (index % 7 == 3) {
+                        assert_se(sd_bus_reply_method_errorf(*c, SD_BUS_ERROR_UNKNOWN_OBJECT, "Go away") >= 0);
+                        continue;
+                }
+
+                assert_se(sd_bus_message_new_method_return(*c, &reply) >= 0);
+                assert_se(sd_bus_message_append(reply, "a{sv}", 1, "Index", "t", index) >= 0);
+                assert_se(sd_bus_send(NULL, reply, NULL) >= 0);
+        }
+}
+
+static void *get_all_server(void *p) {
+        _cleanup_(sd_bus_flush_close_unrefp) sd_bus *bus = NULL;
+        GetAllServer *s = ASSERT_PTR(p);
+        size_t n_replied = 0;
+        sd_id128_t id;
+        int r;
+
+        assert_se(sd_id128_randomize(&id) >= 0);
+
+        assert_se(sd_bus_new(&bus) >= 0);
+        assert_se(sd_bus_set_fd(bus, s->fd, s->fd) >= 0);
+        assert_se(sd_bus_set_server(bus, true, id) >= 0);
+        assert_se(sd_bus_start(bus) >= 0);
+
+        /* Don't reply to any call before the client sent as many as it may have in flight at the same
+         * time, and check that it doesn't send any more than that. */
+        while (n_replied < s->n_paths) {
+                size_t n_calls = 0, n_expected = MIN(s->n_paths - n_replied, BUS_GET_ALL_PIPELINE_MAX);
+                sd_bus_message **calls = NULL;
+
+                CLEANUP_ARRAY(calls, n_calls, bus_message_unref_many);
+
+                for (;;) {
+                        _cleanup_(sd_bus_message_unrefp) sd_bus_message *m = NULL;
+
+                        r = sd_bus_process(bus, &m);
+                        assert_se(r >= 0);
+                        if (r > 0) {
+                                if (!m)
+                                        continue;
+
+                                assert_se(GREEDY_REALLOC(calls, n_calls + 1));
+                                calls[n_calls++] = TAKE_PTR(m);
+                                continue;
+                        }
+
+                        if (n_calls >= n_expected)
+                                break;
+
+                        assert_se(sd_bus_wait(bus, UINT64_MAX) >= 0);
+                }
+
+                /* Give the client a chance to send calls beyond the limit, if it would. */
+                assert_se(sd_bus_wait(bus, 10 * USEC_PER_MSEC) >= 0);
+                while (sd_bus_process(bus, NULL) > 0)
+                        ;
+
+                assert_se(n_calls == n_expected);
+
+                reply_get_all_many(calls, n_calls);
+                n_replied += n_calls;
+        }
+
+        assert_se(sd_bus_flush(bus) >= 0);
+        return NULL;
+}
+
+static void test_get_all_properties_many_one(size_t n_paths) {
+        _cleanup_(sd_bus_flush_close_unrefp) sd_bus *bus = NULL;
+        _cleanup_strv_free_ char **paths = NULL;
+        _cleanup_close_pair_ int pair[2] = EBADF_PAIR;
+        sd_bus_message **replies = NULL;
+        GetAllServer s;
+        pthread_t t;
+
+        CLEANUP_ARRAY(replies, n_paths, bus_message_unref_many);
+
+        log_info("/* %s(%zu) */", __func__, n_paths);
+
+        for (size_t i = 0; i < n_paths; i++)
+                assert_se(strv_extendf(&paths, "/test/%zu", i) >= 0);
+
+        assert_se(socketpair(AF_UNIX, SOCK_STREAM|SOCK_CLOEXEC, 0, pair) >= 0);
+
+        s = (GetAllServer) {
+                .fd = TAKE_FD(pair[1]),
+                .n_paths = n_paths,
+        };
+        assert_se(pthread_create(&t, NULL, get_all_server, &s) == 0);
+
+        assert_se(sd_bus_new(&bus) >= 0);
+        assert_se(sd_bus_set_fd(bus, pair[0], pair[0]) >= 0);
+        TAKE_FD(pair[0]);
+        assert_se(sd_bus_start(bus) >= 0);
+
+        assert_se(bus_get_all_properties_many(bus, "org.freedesktop.systemd.test", paths, n_paths, &replies) >= 0);
+
+        assert_se(pthread_join(t, NULL) == 0);
+
+        for (size_t i = 0; i < n_paths; i++) {
+                static const struct bus_properties_map map[] = {
+                        { "Index", "t", NULL, 0 },
+                        {}
+                };
+                uint64_t index = UINT64_MAX;
+
+                if (i % 7 == 3) {
+                        assert_se(!replies[i]);
+                        continue;
+                }
+
+                assert_se(replies[i]);
+                assert_se(bus_message_map_all_properties(replies[i], map, 0, NULL, &index) >= 0);
+                assert_se(index == i);
+        }
+}
+
+TEST(get_all_properties_many) {
+        test_get_all_properties_many_one(0);
+        test_get_all_properties_many_one(1);
+        test_get_all_properties_many_one(BUS_GET_ALL_PIPELINE_MAX - 1);
+        test_get_all_properties_many_one(BUS_GET_ALL_PIPELINE_MAX);
+        test_get_all_properties_many_one(BUS_GET_ALL_PIPELINE_MAX + 1);
+        test_get_all_properties_many_one(2 * BUS_GET_ALL_PIPELINE_MAX + 5);
+}
+
 DEFINE_TEST_MAIN(LOG_DEBUG);
@@ -17,6 +17,8 @@
 #include "macro.h"
 #include "path-util.h"
 #include "rm-rf.h"
+#include "serialize.h"
+#include "sort-util.h"
 #include "string-util.h"
 #include "strv.h"
 #include "tests.h"
@@ -409,6 +411,60 @@ TEST(error_catching) {
         assert_se(r == 42);
 }
 
+static int exec_timing_compare(const ExecTiming *a, const ExecTiming *b) {
+        return path_compare(a->path, b->path);
+}
+
+static void test_timings_one(bool parallel) {
+        _cleanup_(rm_rf_physical_and_freep) char *tmpdir = NULL;
+        _cleanup_close_ int fd = -EBADF;
+        ExecTiming *timings = NULL;
+        size_t n_timings = 0;
+        const char *name, *name2;
+
+        CLEANUP_ARRAY(timings, n_timings, exec_timing_free_many);
+
+        log_info("/* %s (%s) */", __func__, parallel ? "parallel" : "serial");
+
+        assert_se(mkdtemp_malloc("/tmp/test-exec-util.XXXXXXX", &tmpdir) >= 0);
+
+        const char *dirs[] = { tmpdir, NULL };
+
+        name = strjoina(tmpdir, "/10-foo");
+        name2 = strjoina(tmpdir, "/20-bar");
+
+        assert_se(write_string_file(name, "#!/bin/sh\nexit 0\n", WRITE_STRING_FILE_CREATE) == 0);
+        assert_se(write_string_file(name2, "#!/bin/sh\nsleep 0.1\n", WRITE_STRING_FILE_CREATE) == 0);
+
+        assert_se(chmod(name, 0755) == 0);
+        assert_se(chmod(name2, 0755) == 0);
+
+        if (access(name, X_OK) < 0 && ERRNO_IS_PRIVILEGE(errno))
+                return;
+
+        fd = open_serialization_fd("test-exec-util-timings");
+        assert_se(fd >= 0);
+
+        assert_se(execute_directories_full(dirs, DEFAULT_TIMEOUT_USEC, NULL, NULL, NULL, NULL,
+                                           parallel ? EXEC_DIR_PARALLEL : EXEC_DIR_NONE, fd) >= 0);
+
+        assert_se(exec_timings_read(TAKE_FD(fd), &timings, &n_timings) >= 0);
+        assert_se(n_timings == 2);
+
+        /* In parallel mode the executables are picked up in the order they finish, which is not
+         * deterministic, hence sort by path first. */
+        typesafe_qsort(timings, n_timings, exec_timing_compare);
+
+        assert_se(path_equal(timings[0].path, name));
+        assert_se(path_equal(timings[1].path, name2));
+        assert_se(timings[1].duration >= 100 * USEC_PER_MSEC);
+}
+
+TEST(timings) {
+        test_timings_one(true);
+        test_timings_one(false);
+}
+
 TEST(exec_command_flags_from_strv) {
         ExecCommandFlags flags = 0;
         char **valid_strv = STRV_MAKE("no-env-expand", "no-setuid", "ignore-failure");
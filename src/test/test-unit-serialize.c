@@ -1,8 +1,15 @@
 /* SPDX-License-Identifier: LGPL-2.1-or-later */
 
+#include "cgroup.h"
+#include "fd-util.h"
+#include "fdset.h"
+#include "fs-util.h"
 #include "rm-rf.h"
+#include "serialize.h"
 #include "service.h"
 #include "tests.h"
+#include "tmpfile-util.h"
+#include "unit-serialize.h"
 
 static char *runtime_dir = NULL;
 
@@ -52,6 +59,50 @@ TEST(deserialize_exec_command) {
         test_deserialize_exec_command_one(m, "control-command", "ExecWhat 11 /a/b c d e", -EINVAL);
 }
 
+TEST(cgroup_attribute_cache) {
+        _cleanup_(unlink_tempfilep) char name[] = "/tmp/test-unit-serialize.XXXXXX";
+        _cleanup_(manager_freep) Manager *m = NULL;
+        _cleanup_(unit_freep) Unit *u = NULL, *v = NULL;
+        _cleanup_fdset_free_ FDSet *fds = NULL;
+        _cleanup_fclose_ FILE *f = NULL;
+        _cleanup_free_ char *id = NULL;
+        int r;
+
+        r = manager_new(RUNTIME_SCOPE_USER, MANAGER_TEST_RUN_MINIMAL, &m);
+        if (manager_errno_skip_test(r)) {
+                log_notice_errno(r, "Skipping test: manager_new: %m");
+                return;
+        }
+
+        assert_se(r >= 0);
+
+        assert_se(unit_new_for_name(m, sizeof(Service), "test.service", &u) >= 0);
+        assert_se(unit_new_for_name(m, sizeof(Service), "test2.service", &v) >= 0);
+
+        /* Remembering an attribute again replaces the previous value */
+        assert_se(unit_remember_cgroup_attribute(u, "cpu.weight", "200\n") >= 0);
+        assert_se(unit_remember_cgroup_attribute(u, "cpu.weight", "300\n") >= 0);
+        assert_se(unit_remember_cgroup_attribute(u, "cpu.max", "max 100000\n") >= 0);
+        assert_se(unit_remember_cgroup_attribute(u, "test.attribute", "a \"b\" \\ c") >= 0);
+        assert_se(hashmap_size(u->cgroup_attribute_cache) == 3);
+        assert_se(streq_ptr(hashmap_get(u->cgroup_attribute_cache, "cpu.weight"), "300\n"));
+
+        assert_se(fds = fdset_new());
+        assert_se(fmkostemp_safe(name, "r+", &f) == 0);
+        assert_se(unit_serialize_state(u, f, fds, /* switching_root= */ false) >= 0);
+        rewind(f);
+
+        /* The unit name is consumed by the manager before it hands over to the unit */
+        assert_se(deserialize_read_line(f, &id) > 0);
+        assert_se(streq(id, "test.service"));
+        assert_se(unit_deserialize_state(v, f, fds) >= 0);
+
+        assert_se(hashmap_size(v->cgroup_attribute_cache) == 3);
+        assert_se(streq_ptr(hashmap_get(v->cgroup_attribute_cache, "cpu.weight"), "300\n"));
+        assert_se(streq_ptr(hashmap_get(v->cgroup_attribute_cache, "cpu.max"), "max 100000\n"));
+        assert_se(streq_ptr(hashmap_get(v->cgroup_attribute_cache, "test.attribute"), "a \"b\" \\ c"));
+}
+
 static int intro(void) {
         if (enter_cgroup_subroot(NULL) == -ENOMEDIUM)
                 return log_tests_skipped("cgroupfs not available");
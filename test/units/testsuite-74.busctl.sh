@@ -46,6 +46,12 @@ busctl call -j \
 busctl call --verbose --timeout=60 --expect-reply=yes \
             org.freedesktop.systemd1 /org/freedesktop/systemd1 org.freedesktop.systemd1.Manager \
             ListUnitsByPatterns asas 1 "active" 2 "systemd-*.socket" "*.mount"
+busctl call --json=short \
+            org.freedesktop.systemd1 /org/freedesktop/systemd1 org.freedesktop.systemd1.Manager \
+            ListUnitsAccounting st "" 0 | jq -e '.data[0] | any(.[0] == "init.scope")'
+busctl call --json=short \
+            org.freedesktop.systemd1 /org/freedesktop/systemd1 org.freedesktop.systemd1.Manager \
+            ListUnitsAccounting st "system.slice" 10000000 | jq -e '.data[0] | all(.[0] != "init.scope")'
 
 busctl emit /org/freedesktop/login1 org.freedesktop.login1.Manager \
             PrepareForSleep b false
@@ -90,6 +96,9 @@ busctl get-property -j \
                GetUnitByPID u "hello")
 (! busctl call org.freedesktop.systemd1 /org/freedesktop/systemd1 org.freedesktop.systemd1.Manager \
                -- ListUnitsByNames as -1 "systemd-journald.service")
+# Not a slice
+(! busctl call org.freedesktop.systemd1 /org/freedesktop/systemd1 org.freedesktop.systemd1.Manager \
+               ListUnitsAccounting st "init.scope" 0)
 # Not enough arguments
 (! busctl call org.freedesktop.systemd1 /org/freedesktop/systemd1 org.freedesktop.systemd1.Manager \
                ListUnitsByNames as 99 "systemd-journald.service")